@@ -0,0 +1,402 @@
+/// Host microbenchmarks of the drivers and conversion kernels.
+///
+/// The drivers write to a null interface, which only counts the bytes, so the CPU cost of the
+/// driver code is measured without any bus. The results are written to stdout as JSON, one entry
+/// per benchmark and geometry, with the time and bus bytes per frame (or per call for setters).
+///
+/// Usage: ssd-display-driver-bench [minimum time per benchmark in ms, default 200]
+
+#include "ssd-display-driver/BitTranspose.hpp"
+#include "ssd-display-driver/ColorPlanes.hpp"
+#include "ssd-display-driver/ImageCompression.hpp"
+#include "ssd-display-driver/SSD1305.hpp"
+#include "ssd-display-driver/SSD1306.hpp"
+#include "ssd-display-driver/SSD1675a.hpp"
+#include "ssd-display-driver/SSD1680.hpp"
+#include "ssd-display-driver/SSDInterface.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+/// Discards all bytes, counting them.
+class NullInterface : public SSDInterface
+{
+public:
+    void writeCommand(uint8_t) override
+    {
+        ++commandBytes;
+    }
+
+    void writeCommands(const uint8_t *, size_t length) override
+    {
+        commandBytes += length;
+    }
+
+    void writeCommandSequence(const uint8_t *sequence, size_t length) override
+    {
+        for (size_t i = 0; i + 1 < length; i += 2 + sequence[i + 1])
+        {
+            ++commandBytes;
+            dataBytes += sequence[i + 1];
+        }
+    }
+
+    void writeData(uint8_t) override
+    {
+        ++dataBytes;
+    }
+
+    void writeData(const uint8_t *, size_t length) override
+    {
+        dataBytes += length;
+    }
+
+    void waitUntilIdle() override
+    {
+    }
+
+    bool isBusy() override
+    {
+        return false;
+    }
+
+    size_t commandBytes = 0;
+    size_t dataBytes = 0;
+};
+
+struct Geometry
+{
+    const char *name;
+    uint8_t width;
+    uint8_t height;
+};
+
+constexpr Geometry OledGeometries[] = {
+    {"128x32", 128, 32},
+    {"128x64", 128, 64},
+    {"132x64", 132, 64},
+};
+constexpr const char *EPaperGeometry = "152x296";
+constexpr size_t EPaperWidth = 152;
+constexpr size_t EPaperHeight = 296;
+constexpr size_t EPaperPlaneLength = EPaperWidth / 8 * EPaperHeight;
+
+std::chrono::nanoseconds minimumTime{std::chrono::milliseconds(200)};
+bool isFirstResult = true;
+
+/// Keeps the results of the kernels alive.
+volatile uint8_t sink;
+
+/// Runs \p frame until the minimum time has passed and prints the result.
+/// \param frame Function called with the iteration number, doing one frame.
+template <typename Frame>
+void run(const char *name, const char *geometry, NullInterface &interface, Frame frame)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // warm up caches and the shadows of the drivers
+    for (size_t i = 0; i < 8; ++i)
+        frame(i);
+
+    interface.commandBytes = 0;
+    interface.dataBytes = 0;
+
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration{};
+
+    // check the clock every 64 frames only, some frames take a few ns
+    while (elapsed < minimumTime)
+    {
+        for (size_t i = 0; i < 64; ++i)
+            frame(iterations++);
+
+        elapsed = Clock::now() - start;
+    }
+
+    const double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+
+    std::printf("%s\n    {\"name\": \"%s\", \"geometry\": \"%s\", \"iterations\": %zu, "
+                "\"ns_per_frame\": %.1f, \"bytes_per_frame\": %.1f, "
+                "\"command_bytes_per_frame\": %.1f, \"data_bytes_per_frame\": %.1f}",
+                isFirstResult ? "" : ",", name, geometry, iterations, nanoseconds / iterations,
+                double(interface.commandBytes + interface.dataBytes) / iterations,
+                double(interface.commandBytes) / iterations,
+                double(interface.dataBytes) / iterations);
+
+    isFirstResult = false;
+}
+
+std::vector<uint8_t> randomBytes(size_t length)
+{
+    std::vector<uint8_t> bytes(length);
+
+    for (auto &byte : bytes)
+        byte = static_cast<uint8_t>(std::rand());
+
+    return bytes;
+}
+
+/// Blank image with a text-like block, compressing like a typical splash screen.
+std::vector<uint8_t> splashImage(size_t width, size_t numberOfPages)
+{
+    std::vector<uint8_t> image(width * numberOfPages, 0);
+
+    for (size_t page = numberOfPages / 4; page < numberOfPages / 2 + 1; ++page)
+        for (size_t column = width / 8; column < width - width / 8; ++column)
+            image[page * width + column] = column % 6 < 5 ? static_cast<uint8_t>(std::rand()) : 0;
+
+    return image;
+}
+
+//--------------------------------------------------------------------------------------------------
+void benchmarkOled(const Geometry &geometry)
+{
+    NullInterface interface;
+    SSD1306 display(interface);
+
+    const size_t numberOfPages = geometry.height / 8;
+    const size_t length = geometry.width * numberOfPages;
+
+    display.setMemoryAddressingMode(SSD1305::AddressingMode::Horizontal);
+    display.setColumnAddress(0, geometry.width - 1);
+    display.setPageAddress(0, numberOfPages - 1);
+
+    const auto image = randomBytes(length);
+    const auto otherImage = randomBytes(length);
+    const size_t rowMajorLength = size_t{(geometry.width + 7u) / 8u} * geometry.height;
+    const auto rowMajorImage = randomBytes(rowMajorLength);
+    const auto otherRowMajorImage = randomBytes(rowMajorLength);
+    std::vector<uint8_t> pageMajorImage(length);
+
+    run("SSD1305::submitImage", geometry.name, interface, [&](size_t i) {
+        display.submitImage(i % 2 ? image.data() : otherImage.data(), length);
+    });
+
+    std::vector<uint8_t> shadow(length);
+    std::vector<uint8_t> changingImage = image;
+    display.enableDifferentialUpdate(shadow.data(), length, geometry.width);
+
+    // a clock-like update, a few bytes change per frame
+    run("SSD1305::submitImage/differential", geometry.name, interface, [&](size_t i) {
+        changingImage[(i * 7) % length] ^= 0xFF;
+        display.submitImage(changingImage.data(), length);
+    });
+
+    run("SSD1305::submitRowMajorImage/differential", geometry.name, interface, [&](size_t i) {
+        display.submitRowMajorImage(i % 2 ? rowMajorImage.data() : otherRowMajorImage.data(),
+                                    geometry.width, geometry.height);
+    });
+
+    display.disableDifferentialUpdate();
+
+    run("SSD1305::submitRowMajorImage", geometry.name, interface, [&](size_t) {
+        display.submitRowMajorImage(rowMajorImage.data(), geometry.width, geometry.height);
+    });
+
+    const auto splash = splashImage(geometry.width, numberOfPages);
+    std::vector<uint8_t> compressed(image_compression::maxCompressedLength(length));
+    compressed.resize(
+        image_compression::compress(splash.data(), length, compressed.data(), compressed.size()));
+
+    run("SSD1305::submitCompressedImage", geometry.name, interface, [&](size_t) {
+        display.submitCompressedImage(compressed.data(), compressed.size(), geometry.width,
+                                      numberOfPages);
+    });
+
+    // a 16x16 working set, which the byte cache holds without a read path
+    run("SSD1305::togglePixel", geometry.name, interface, [&](size_t i) {
+        display.togglePixel(i % 16, (i / 16) % 16);
+    });
+
+    run("bit_transpose::rowMajorToPageMajor", geometry.name, interface, [&](size_t) {
+        bit_transpose::rowMajorToPageMajor(rowMajorImage.data(), geometry.width, geometry.height,
+                                           pageMajorImage.data());
+        sink = pageMajorImage[0];
+    });
+}
+
+//--------------------------------------------------------------------------------------------------
+void benchmarkSetters()
+{
+    using Display = SSD1306;
+    using Setter = void (*)(Display &, size_t);
+
+    struct Entry
+    {
+        const char *name;
+        Setter setter;
+    };
+
+    // alternating values, so the register shadow does not drop the writes
+    static constexpr Entry Setters[] = {
+        {"SSD1305::setColumnStartAddress",
+         [](Display &d, size_t i) { d.setColumnStartAddress(i % 2); }},
+        {"SSD1305::setMemoryAddressingMode",
+         [](Display &d, size_t i) {
+             d.setMemoryAddressingMode(i % 2 ? SSD1305::AddressingMode::Horizontal
+                                             : SSD1305::AddressingMode::Vertical);
+         }},
+        {"SSD1305::setColumnAddress", [](Display &d, size_t i) { d.setColumnAddress(i % 2, 127); }},
+        {"SSD1305::setPageAddress", [](Display &d, size_t i) { d.setPageAddress(i % 2, 7); }},
+        {"SSD1305::setDisplayStartLine",
+         [](Display &d, size_t i) { d.setDisplayStartLine(i % 64); }},
+        {"SSD1305::setContrastControl",
+         [](Display &d, size_t i) { d.setContrastControl(static_cast<uint8_t>(i)); }},
+        {"SSD1305::setBrightness",
+         [](Display &d, size_t i) { d.setBrightness(static_cast<uint8_t>(i)); }},
+        {"SSD1305::setLUT", [](Display &d, size_t i) { d.setLUT(i % 64, 63, 63, 63); }},
+        {"SSD1305::setSegmentRemap", [](Display &d, size_t i) { d.setSegmentRemap(i % 2); }},
+        {"SSD1305::setEntireDisplayOn", [](Display &d, size_t i) { d.setEntireDisplayOn(i % 2); }},
+        {"SSD1305::setInverseDisplay", [](Display &d, size_t i) { d.setInverseDisplay(i % 2); }},
+        {"SSD1305::setMultiplexRatio",
+         [](Display &d, size_t i) { d.setMultiplexRatio(15 + i % 49); }},
+        {"SSD1305::setDimMode",
+         [](Display &d, size_t i) { d.setDimMode(static_cast<uint8_t>(i), 0x80); }},
+        {"SSD1305::setDisplayState",
+         [](Display &d, size_t i) {
+             d.setDisplayState(i % 2 ? SSD1305::DisplayState::On : SSD1305::DisplayState::Dimmed);
+         }},
+        {"SSD1305::setPageStartAddress",
+         [](Display &d, size_t i) { d.setPageStartAddress(i % 8); }},
+        {"SSD1305::setComOutputMode",
+         [](Display &d, size_t i) {
+             d.setComOutputMode(i % 2 ? SSD1305::ComMode::Remap : SSD1305::ComMode::Normal);
+         }},
+        {"SSD1305::setDisplayOffset", [](Display &d, size_t i) { d.setDisplayOffset(i % 64); }},
+        {"SSD1305::setDisplayClockDivide",
+         [](Display &d, size_t i) { d.setDisplayClockDivide(i % 16, 8); }},
+        {"SSD1305::setAreaColorModeAndPowerMode",
+         [](Display &d, size_t i) {
+             d.setAreaColorModeAndPowerMode(SSD1305::ColorMode::Monochrome,
+                                            i % 2 ? SSD1305::PowerMode::LowPower
+                                                  : SSD1305::PowerMode::Normal);
+         }},
+        {"SSD1305::setPrechargingPeriod",
+         [](Display &d, size_t i) { d.setPrechargingPeriod(1 + i % 15, 2); }},
+        {"SSD1305::setComPinConfig", [](Display &d, size_t i) { d.setComPinConfig(i % 2, false); }},
+        {"SSD1305::setVcomhDeselectLevel",
+         [](Display &d, size_t i) {
+             d.setVcomhDeselectLevel(i % 2 ? SSD1305::VcomhLevel::x0_77
+                                           : SSD1305::VcomhLevel::x0_83);
+         }},
+        {"SSD1306::setChargePump", [](Display &d, size_t i) { d.setChargePump(i % 2); }},
+        {"SSD1305::setVerticalScrollArea",
+         [](Display &d, size_t i) { d.setVerticalScrollArea(i % 8, 64 - i % 8); }},
+    };
+
+    for (const auto &entry : Setters)
+    {
+        NullInterface interface;
+        Display display(interface);
+
+        run(entry.name, "128x64", interface, [&](size_t i) { entry.setter(display, i); });
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void benchmarkEPaper()
+{
+    NullInterface interface;
+    SSD1675a panel(interface);
+    panel.selectLut(SSD1675a::LutSelection::Default);
+    panel.init();
+
+    const auto bwPlane = randomBytes(EPaperPlaneLength);
+    const auto redPlane = randomBytes(EPaperPlaneLength);
+
+    std::vector<uint8_t> indexedImage(EPaperWidth * EPaperHeight);
+    for (auto &pixel : indexedImage)
+        pixel = std::rand() % 3;
+
+    std::vector<uint8_t> packedImage(EPaperWidth / 4 * EPaperHeight);
+    for (auto &pixels : packedImage)
+        pixels = static_cast<uint8_t>(std::rand());
+
+    std::vector<uint8_t> bwOut(EPaperPlaneLength);
+    std::vector<uint8_t> redOut(EPaperPlaneLength);
+
+    run("SSD1675a::submitPlanes", EPaperGeometry, interface, [&](size_t) {
+        panel.submitPlanes(bwPlane.data(), redPlane.data(), EPaperPlaneLength, false);
+    });
+
+    // the whole tri-color path: packing an indexed image and submitting both planes
+    run("SSD1675a::submitPlanes/pack8bpp", EPaperGeometry, interface, [&](size_t) {
+        color_planes::pack8bpp(indexedImage.data(), EPaperWidth, EPaperHeight, bwOut.data(),
+                               redOut.data(), panel.planeFormat());
+        panel.submitPlanes(bwOut.data(), redOut.data(), EPaperPlaneLength, false);
+    });
+
+    run("SSD1675a::submitImage", EPaperGeometry, interface, [&](size_t) {
+        panel.submitImage(bwPlane.data(), (1 << 24) | EPaperPlaneLength);
+        panel.submitImage(redPlane.data(), (1 << 26) | EPaperPlaneLength);
+    });
+
+    std::vector<uint8_t> compressedBw(image_compression::maxCompressedLength(EPaperPlaneLength));
+    const auto splash = splashImage(EPaperWidth / 8, EPaperHeight);
+    compressedBw.resize(image_compression::compress(splash.data(), EPaperPlaneLength,
+                                                    compressedBw.data(), compressedBw.size()));
+
+    run("SSD1675a::submitCompressedPlanes", EPaperGeometry, interface, [&](size_t) {
+        panel.submitCompressedPlanes(compressedBw.data(), compressedBw.size(), nullptr, 0, false);
+    });
+
+    run("SSD1675a::clearPlanes", EPaperGeometry, interface, [&](size_t) { panel.clearPlanes(); });
+
+    run("SSD1675a::loadLut", EPaperGeometry, interface, [&](size_t) {
+        panel.invalidateLut();
+        panel.loadLut();
+    });
+
+    NullInterface ssd1680Interface;
+    SSD1680 ssd1680(ssd1680Interface);
+    ssd1680.selectLut(SSD1675a::LutSelection::Default);
+
+    run("SSD1680::loadLut", EPaperGeometry, ssd1680Interface, [&](size_t) {
+        ssd1680.invalidateLut();
+        ssd1680.loadLut();
+    });
+
+    run("color_planes::pack8bpp", EPaperGeometry, interface, [&](size_t) {
+        color_planes::pack8bpp(indexedImage.data(), EPaperWidth, EPaperHeight, bwOut.data(),
+                               redOut.data(), panel.planeFormat());
+        sink = bwOut[0];
+    });
+
+    run("color_planes::pack2bpp", EPaperGeometry, interface, [&](size_t) {
+        color_planes::pack2bpp(packedImage.data(), EPaperWidth, EPaperHeight, bwOut.data(),
+                               redOut.data(), panel.planeFormat());
+        sink = bwOut[0];
+    });
+
+    run("image_compression::Decoder", EPaperGeometry, interface, [&](size_t) {
+        image_compression::Decoder decoder(compressedBw.data(), compressedBw.size());
+        decoder.decode(bwOut.data(), bwOut.size());
+        sink = bwOut[0];
+    });
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        minimumTime = std::chrono::milliseconds(std::atoi(argv[1]));
+
+    std::srand(1);
+    std::printf("{\n  \"benchmarks\": [");
+
+    for (const auto &geometry : OledGeometries)
+        benchmarkOled(geometry);
+
+    benchmarkSetters();
+    benchmarkEPaper();
+
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Conversion of row-major 1bpp images into the page-major layout of the SSD1305/SSD1306 GDDRAM.
+///
+/// Row-major images store 8 horizontal pixels per byte, MSB = leftmost pixel. Page-major images
+/// store 8 vertical pixels per byte, LSB = top pixel, one page of 8 rows after the other.
+/// The conversion uses 8x8 bit matrix transposes with AVX2, SSE2 or NEON, if available at
+/// compile time, and a portable 64 bit SWAR implementation otherwise. Defining
+/// SSD_DISPLAY_DRIVER_PORTABLE_TRANSPOSE selects the SWAR implementation in any case.
+namespace bit_transpose
+{
+enum class Mirror : uint8_t
+{
+    None = 0,
+    Horizontal = 0b01, //!< Mirrors columns, e.g. for a remapped segment output.
+    Vertical = 0b10,   //!< Mirrors rows, e.g. for a remapped COM output.
+    Both = 0b11        //!< Rotates by 180 degrees.
+};
+
+/// Maximum image width supported by the vectorized paths.
+constexpr size_t MaxWidth = 2048;
+
+/// Converts one page (8 rows) of a row-major image.
+/// \param image       First row of the row-major image.
+/// \param width       Image width in pixels, up to MaxWidth.
+/// \param height      Image height in pixels.
+/// \param page        Index of the page to convert.
+/// \param destination Page buffer of \p width bytes.
+/// \param mirror      Mirroring applied during the conversion.
+void convertPage(const uint8_t *image, size_t width, size_t height, size_t page,
+                 uint8_t *destination, Mirror mirror = Mirror::None);
+
+/// Converts a whole row-major image.
+/// \param destination Buffer of \p width * ((\p height + 7) / 8) bytes.
+void rowMajorToPageMajor(const uint8_t *image, size_t width, size_t height,
+                         uint8_t *destination, Mirror mirror = Mirror::None);
+
+/// Bit by bit implementation of rowMajorToPageMajor(), used as reference.
+void rowMajorToPageMajorReference(const uint8_t *image, size_t width, size_t height,
+                                  uint8_t *destination, Mirror mirror = Mirror::None);
+} // namespace bit_transpose
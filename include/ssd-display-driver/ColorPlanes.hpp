@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Conversion of indexed white/black/red images into the BW and red RAM planes of the
+/// SSD1675a/SSD1680 tri-color ePaper controllers.
+///
+/// Both planes are produced in a single pass, row-major with the MSB being the leftmost pixel.
+/// Images can be converted in bands of rows, e.g. to stream them to the controller.
+/// 8bpp images are packed with AVX2 or SSE2, if available at compile time, and a 64 bit SWAR
+/// implementation otherwise. 2bpp images are packed using a lookup table.
+namespace color_planes
+{
+/// Color indices of the source images.
+enum Index : uint8_t
+{
+    White = 0,
+    Black = 1,
+    Red = 2
+};
+
+/// Bit polarity of the planes, given by the RAM options of display update control 1.
+/// Natively, a set BW bit is white and a set red bit is red.
+struct PlaneFormat
+{
+    bool invertBlack; //!< BW RAM is inverted, a set BW bit is black.
+    bool invertRed;   //!< Red RAM is inverted, a cleared red bit is red.
+};
+
+/// Packs an image with one color index per byte. Indices other than Black and Red are white.
+/// \param pixels   First row of the image, \p width bytes per row.
+/// \param width    Image width in pixels.
+/// \param rows     Number of rows to be converted.
+/// \param bwPlane  Destination of (\p width + 7) / 8 bytes per row.
+/// \param redPlane Destination of (\p width + 7) / 8 bytes per row.
+/// \param format   Bit polarity of the planes.
+void pack8bpp(const uint8_t *pixels, size_t width, size_t rows, uint8_t *bwPlane,
+              uint8_t *redPlane, PlaneFormat format);
+
+/// Packs an image with four color indices per byte, the MSBs being the leftmost pixel.
+/// Index 3 is white.
+/// \param pixels First row of the image, (\p width + 3) / 4 bytes per row.
+/// \see pack8bpp()
+void pack2bpp(const uint8_t *pixels, size_t width, size_t rows, uint8_t *bwPlane,
+              uint8_t *redPlane, PlaneFormat format);
+} // namespace color_planes
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Two frame buffers for rendering the next frame while the current one is transferred.
+///
+/// Ownership: the back buffer belongs to the renderer until submit() is called. Then the driver
+/// owns it until its transfer has completed. The drivers wait for the running transfer before
+/// starting the next one. So the buffer returned by backBuffer() after submit() belongs to the
+/// renderer right away.
+/// \tparam Size Size of one frame in bytes.
+template <size_t Size>
+class DoubleBuffer
+{
+public:
+    /// Buffer the next frame is rendered into.
+    uint8_t *backBuffer()
+    {
+        return buffers[backIndex].data();
+    }
+
+    /// Starts the transfer of the back buffer and swaps the buffers.
+    /// \param driver Driver providing submitImageAsync(const uint8_t *, size_t).
+    template <typename Driver>
+    void submit(Driver &driver)
+    {
+        driver.submitImageAsync(buffers[backIndex].data(), Size);
+        backIndex ^= 1;
+    }
+
+    static constexpr size_t size()
+    {
+        return Size;
+    }
+
+private:
+    std::array<std::array<uint8_t, Size>, 2> buffers{};
+    size_t backIndex = 0;
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "SSD1675a.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Updates several SSD1675a/SSD1680 panels, overlapping their refreshes.
+///
+/// Each panel has its own SSDInterface and busy pin. poll() uploads the RAM of one waiting panel
+/// while the others are refreshing and tracks the refreshes using the non-blocking API of the
+/// drivers. A full update cycle of all panels takes about the upload times plus a single
+/// refresh, instead of the sum of all refreshes.
+///
+/// The images passed to requestUpdate() belong to the scheduler until the update of the panel
+/// has completed, see isComplete() and onPanelComplete().
+/// \tparam MaxPanels Number of panels the scheduler can hold.
+template <size_t MaxPanels>
+class EPaperScheduler
+{
+public:
+    using PanelCallback = void (*)(void *context, size_t panel);
+
+    /// Returned by addPanel() if all slots are taken.
+    static constexpr size_t InvalidPanel = MaxPanels;
+
+    /// Adds a panel, which has to be initialized already.
+    /// \return Index of the panel, InvalidPanel if the scheduler is full.
+    size_t addPanel(SSD1675a &panel)
+    {
+        if (numberOfPanels == MaxPanels)
+            return InvalidPanel;
+
+        slots[numberOfPanels] = Slot{&panel};
+        return numberOfPanels++;
+    }
+
+    /// Requests writing both planes into the panel RAM and refreshing it.
+    ///
+    /// A request for a panel still waiting for its upload replaces that request. A request for a
+    /// refreshing panel is uploaded once the refresh is done.
+    /// \param panel       Index returned by addPanel().
+    /// \param bwImage     BW RAM data, nullptr to leave the BW RAM untouched.
+    /// \param redImage    Red RAM data, nullptr to leave the red RAM untouched.
+    /// \param planeLength Size of each plane in bytes.
+    /// \param lut         LUT of the refresh, uploaded only if it is not resident.
+    /// \return False if \p panel is invalid.
+    bool requestUpdate(size_t panel, const uint8_t *bwImage, const uint8_t *redImage,
+                       size_t planeLength,
+                       SSD1675a::LutSelection lut = SSD1675a::LutSelection::Default)
+    {
+        if (panel >= numberOfPanels)
+            return false;
+
+        auto &slot = slots[panel];
+        slot.bwImage = bwImage;
+        slot.redImage = redImage;
+        slot.planeLength = planeLength;
+        slot.lut = lut;
+        slot.isPending = true;
+        return true;
+    }
+
+    /// Sets a function called by poll() whenever the update of a panel has completed.
+    void onPanelComplete(PanelCallback callback, void *context)
+    {
+        panelCallback = callback;
+        panelContext = context;
+    }
+
+    /// Advances all updates: finishes the refreshes of panels which are not busy anymore and
+    /// uploads the next waiting panel. At most one panel is uploaded per call, so the refreshes
+    /// of the others are noticed in between.
+    /// \return True if all updates have completed.
+    bool poll()
+    {
+        for (size_t i = 0; i < numberOfPanels; ++i)
+        {
+            auto &slot = slots[i];
+
+            if (!slot.isRefreshing || !slot.panel->poll())
+                continue;
+
+            slot.isRefreshing = false;
+
+            if (panelCallback != nullptr)
+                panelCallback(panelContext, i);
+        }
+
+        for (size_t n = 0; n < numberOfPanels; ++n)
+        {
+            // round robin, so no panel is starved by frequent requests of another one
+            const size_t i = (nextPanel + n) % numberOfPanels;
+            auto &slot = slots[i];
+
+            if (!slot.isPending || slot.isRefreshing ||
+                slot.panel->runningOperation() != SSD1675a::Operation::None)
+                continue;
+
+            slot.isPending = false;
+            slot.panel->submitPlanes(slot.bwImage, slot.redImage, slot.planeLength, false);
+            slot.isRefreshing = slot.panel->startRefresh(slot.lut);
+            nextPanel = (i + 1) % numberOfPanels;
+            break;
+        }
+
+        return isIdle();
+    }
+
+    /// Calls poll() until all updates have completed.
+    void run()
+    {
+        while (!poll())
+        {
+        }
+    }
+
+    /// \return True if the panel has no waiting or running update.
+    bool isComplete(size_t panel) const
+    {
+        return panel >= numberOfPanels || (!slots[panel].isPending && !slots[panel].isRefreshing);
+    }
+
+    /// \return True if no panel has a waiting or running update.
+    bool isIdle() const
+    {
+        for (size_t i = 0; i < numberOfPanels; ++i)
+            if (!isComplete(i))
+                return false;
+
+        return true;
+    }
+
+    size_t size() const
+    {
+        return numberOfPanels;
+    }
+
+private:
+    struct Slot
+    {
+        SSD1675a *panel = nullptr;
+        const uint8_t *bwImage = nullptr;
+        const uint8_t *redImage = nullptr;
+        size_t planeLength = 0;
+        SSD1675a::LutSelection lut = SSD1675a::LutSelection::Default;
+        bool isPending = false;    //!< Waiting for its upload.
+        bool isRefreshing = false; //!< Uploaded, refresh running.
+    };
+
+    std::array<Slot, MaxPanels> slots{};
+    size_t numberOfPanels = 0;
+    size_t nextPanel = 0;
+
+    PanelCallback panelCallback = nullptr;
+    void *panelContext = nullptr;
+};
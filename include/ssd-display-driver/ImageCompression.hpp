@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Run-length compression of 1bpp images, e.g. splash screens and icons stored in flash.
+///
+/// The format is a PackBits variant tuned for display planes, where long runs of blank (0x00)
+/// or filled (0xFF) bytes dominate. Each block starts with a control byte:
+///  - 0x00..0x7F: literal, the next control + 1 bytes are copied (1..128 bytes).
+///  - 0x80..0xBF: run, the next byte is repeated (control & 0x3F) + 3 times (3..66 bytes).
+///  - 0xC0..0xDF: run of 0x00 bytes, (control & 0x1F) + 1 times (1..32 bytes).
+///  - 0xE0..0xFF: run of 0xFF bytes, (control & 0x1F) + 1 times (1..32 bytes).
+///
+/// The format does not depend on the image layout, so page-major SSD1305 images as well as
+/// row-major SSD1675a planes can be compressed. The Decoder expands the data chunk by chunk,
+/// straight into the bus writes of the drivers, without a buffer for the whole image.
+namespace image_compression
+{
+/// Worst case size of compressed data, all literals.
+constexpr size_t maxCompressedLength(size_t length)
+{
+    return length + (length + 127) / 128;
+}
+
+/// Compresses \p length bytes, e.g. offline or at build time on the host.
+/// \return Length of the compressed data, 0 if it does not fit into \p capacity bytes.
+size_t compress(const uint8_t *source, size_t length, uint8_t *destination, size_t capacity);
+
+/// Streaming decoder, expanding compressed data in chunks of any size.
+class Decoder
+{
+public:
+    Decoder(const uint8_t *data, size_t length) : input(data), end(data + length){};
+
+    /// Decodes up to \p capacity bytes, continuing where the last call stopped.
+    /// \return Number of bytes written to \p destination, less than \p capacity only at the end
+    /// of the data.
+    size_t decode(uint8_t *destination, size_t capacity);
+
+    /// \return True if all data has been decoded.
+    bool isFinished() const
+    {
+        return remaining == 0 && input == end;
+    }
+
+private:
+    const uint8_t *input;
+    const uint8_t *end;
+
+    /// Bytes left of the current block.
+    size_t remaining = 0;
+
+    /// True if the current block is a literal, otherwise \p value is repeated.
+    bool isLiteral = false;
+    uint8_t value = 0;
+};
+} // namespace image_compression
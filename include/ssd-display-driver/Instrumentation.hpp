@@ -0,0 +1,384 @@
+#pragma once
+
+#include "SSDAsyncInterface.hpp"
+#include "SSDInterface.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Bus and latency instrumentation of the drivers.
+///
+/// A Recorder collects counters and latency histograms per operation. The bus traffic is counted
+/// by InstrumentedInterface or InstrumentedAsyncInterface, which wrap the hardware interface
+/// passed to the driver. The drivers mark their operations (e.g. submitImage()) with
+/// SSD_INSTRUMENT_OPERATION, if built with SSD_DISPLAY_DRIVER_INSTRUMENTATION; the traffic in
+/// between is accounted to Operation::Configuration. Without the define, the hooks compile to
+/// nothing and the drivers have no setInstrumentation().
+namespace instrumentation
+{
+/// Microseconds of a free running clock, e.g. a timer or the cycle counter.
+using Clock = uint32_t (*)();
+
+enum class Operation : uint8_t
+{
+    Configuration, //!< Commands outside of any other operation, e.g. register setters.
+    Init,          //!< Controller initialization and resets.
+    SubmitImage,   //!< Image and RAM plane transfers.
+    PixelUpdate,   //!< Read-modify-write pixel updates.
+    LutUpload,     //!< Waveform uploads.
+    Refresh,       //!< ePaper refreshes.
+    NumberOfOperations
+};
+
+/// Latency histogram with logarithmic buckets. Bucket 0 holds 0 µs, bucket n holds
+/// [2^(n-1), 2^n) µs.
+struct Histogram
+{
+    static constexpr size_t NumberOfBuckets = 33;
+
+    std::array<uint32_t, NumberOfBuckets> buckets{};
+    uint32_t count = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+
+    void record(uint32_t us)
+    {
+        size_t bucket = 0;
+        for (uint32_t value = us; value != 0; value >>= 1)
+            ++bucket;
+
+        ++buckets[bucket];
+        ++count;
+        totalUs += us;
+
+        if (us > maxUs)
+            maxUs = us;
+    }
+};
+
+struct OperationStatistics
+{
+    uint32_t calls = 0;            //!< Completed operations, nested ones of the same type once.
+    uint32_t commandTransfers = 0; //!< Calls writing command bytes.
+    uint32_t commandBytes = 0;
+    uint32_t dataTransfers = 0; //!< Calls writing data bytes, including parameters.
+    uint32_t dataBytes = 0;
+    uint32_t readTransfers = 0;
+    Histogram latency; //!< Duration of the operations, including waits.
+};
+
+/// Copy of all counters, see Recorder::snapshot().
+struct Snapshot
+{
+    std::array<OperationStatistics, static_cast<size_t>(Operation::NumberOfOperations)>
+        operations{};
+    Histogram idleWait;     //!< Time blocked in SSDInterface::waitUntilIdle().
+    Histogram transferWait; //!< Time blocked in SSDAsyncInterface::waitForTransfer().
+
+    const OperationStatistics &operator[](Operation operation) const
+    {
+        return operations[static_cast<size_t>(operation)];
+    }
+};
+
+/// Collects the counters of one or more drivers.
+class Recorder
+{
+public:
+    /// \param clock Time source of the latencies, nullptr to count bytes only.
+    explicit Recorder(Clock clock = nullptr) : clock(clock){};
+
+    Snapshot snapshot() const
+    {
+        return counters;
+    }
+
+    void reset()
+    {
+        counters = Snapshot{};
+    }
+
+    Operation currentOperation() const
+    {
+        return current;
+    }
+
+    uint32_t now() const
+    {
+        return clock != nullptr ? clock() : 0;
+    }
+
+    void recordCommands(size_t transfers, size_t bytes)
+    {
+        auto &statistics = counters.operations[static_cast<size_t>(current)];
+        statistics.commandTransfers += transfers;
+        statistics.commandBytes += bytes;
+    }
+
+    void recordData(size_t bytes)
+    {
+        auto &statistics = counters.operations[static_cast<size_t>(current)];
+        ++statistics.dataTransfers;
+        statistics.dataBytes += bytes;
+    }
+
+    void recordRead()
+    {
+        ++counters.operations[static_cast<size_t>(current)].readTransfers;
+    }
+
+    void recordIdleWait(uint32_t startUs)
+    {
+        counters.idleWait.record(now() - startUs);
+    }
+
+    void recordTransferWait(uint32_t startUs)
+    {
+        counters.transferWait.record(now() - startUs);
+    }
+
+private:
+    friend class ScopedOperation;
+
+    Clock clock;
+    Operation current = Operation::Configuration;
+    Snapshot counters;
+};
+
+/// Accounts the traffic to \p operation until it goes out of scope and records its latency.
+/// A scope nested into one of the same operation is transparent.
+class ScopedOperation
+{
+public:
+    ScopedOperation(Recorder *recorder, Operation operation)
+        : recorder(recorder != nullptr && recorder->current != operation ? recorder : nullptr),
+          previous(recorder != nullptr ? recorder->current : Operation::Configuration),
+          startUs(this->recorder != nullptr ? recorder->now() : 0)
+    {
+        if (this->recorder != nullptr)
+            this->recorder->current = operation;
+    }
+
+    ~ScopedOperation()
+    {
+        if (recorder == nullptr)
+            return;
+
+        auto &statistics = recorder->counters.operations[static_cast<size_t>(recorder->current)];
+        ++statistics.calls;
+        statistics.latency.record(recorder->now() - startUs);
+
+        recorder->current = previous;
+    }
+
+    ScopedOperation(const ScopedOperation &) = delete;
+    ScopedOperation &operator=(const ScopedOperation &) = delete;
+
+private:
+    Recorder *recorder;
+    Operation previous;
+    uint32_t startUs;
+};
+
+/// Counts the bytes of the record encoded command sequence of SSDInterface.
+inline void recordCommandSequence(Recorder &recorder, const uint8_t *sequence, size_t length)
+{
+    size_t commands = 0;
+    size_t parameters = 0;
+
+    for (size_t i = 0; i + 1 < length; i += 2 + sequence[i + 1])
+    {
+        ++commands;
+        parameters += sequence[i + 1];
+    }
+
+    recorder.recordCommands(commands, commands);
+
+    if (parameters != 0)
+        recorder.recordData(parameters);
+}
+
+/// Counts the bytes of the segments of SSDInterface::writeSegments(), each as one transfer.
+inline void recordSegments(Recorder &recorder, const SSDInterface::Segment *segments,
+                           size_t numberOfSegments)
+{
+    for (size_t i = 0; i < numberOfSegments; ++i)
+    {
+        if (segments[i].length == 0)
+            continue;
+
+        if (segments[i].type == SSDInterface::Segment::Type::Command)
+            recorder.recordCommands(1, segments[i].length);
+        else
+            recorder.recordData(segments[i].length);
+    }
+}
+
+/// Decorator of a blocking SSDInterface counting its traffic.
+class InstrumentedInterface : public SSDInterface
+{
+public:
+    InstrumentedInterface(SSDInterface &interface, Recorder &recorder)
+        : interface(interface), recorder(recorder){};
+
+    void writeCommand(uint8_t cmd) override
+    {
+        recorder.recordCommands(1, 1);
+        interface.writeCommand(cmd);
+    }
+
+    void writeCommands(const uint8_t *cmds, size_t length) override
+    {
+        recorder.recordCommands(1, length);
+        interface.writeCommands(cmds, length);
+    }
+
+    void writeCommandSequence(const uint8_t *sequence, size_t length) override
+    {
+        recordCommandSequence(recorder, sequence, length);
+        interface.writeCommandSequence(sequence, length);
+    }
+
+    void writeSegments(const Segment *segments, size_t numberOfSegments) override
+    {
+        recordSegments(recorder, segments, numberOfSegments);
+        interface.writeSegments(segments, numberOfSegments);
+    }
+
+    void writeData(uint8_t data) override
+    {
+        recorder.recordData(1);
+        interface.writeData(data);
+    }
+
+    void writeData(const uint8_t *data, size_t length) override
+    {
+        recorder.recordData(length);
+        interface.writeData(data, length);
+    }
+
+    bool readData(uint8_t *data, size_t length) override
+    {
+        recorder.recordRead();
+        return interface.readData(data, length);
+    }
+
+    void waitUntilIdle() override
+    {
+        const uint32_t startUs = recorder.now();
+        interface.waitUntilIdle();
+        recorder.recordIdleWait(startUs);
+    }
+
+    bool isBusy() override
+    {
+        return interface.isBusy();
+    }
+
+private:
+    SSDInterface &interface;
+    Recorder &recorder;
+};
+
+/// Decorator of an SSDAsyncInterface counting its traffic, background transfers included.
+class InstrumentedAsyncInterface : public SSDAsyncInterface
+{
+public:
+    InstrumentedAsyncInterface(SSDAsyncInterface &interface, Recorder &recorder)
+        : interface(interface), recorder(recorder)
+    {
+        interface.setCompletionCallback(forwardCompletion, this);
+    }
+
+    void writeCommand(uint8_t cmd) override
+    {
+        recorder.recordCommands(1, 1);
+        interface.writeCommand(cmd);
+    }
+
+    void writeCommands(const uint8_t *cmds, size_t length) override
+    {
+        recorder.recordCommands(1, length);
+        interface.writeCommands(cmds, length);
+    }
+
+    void writeCommandSequence(const uint8_t *sequence, size_t length) override
+    {
+        recordCommandSequence(recorder, sequence, length);
+        interface.writeCommandSequence(sequence, length);
+    }
+
+    void writeSegments(const Segment *segments, size_t numberOfSegments) override
+    {
+        recordSegments(recorder, segments, numberOfSegments);
+        interface.writeSegments(segments, numberOfSegments);
+    }
+
+    void writeData(uint8_t data) override
+    {
+        recorder.recordData(1);
+        interface.writeData(data);
+    }
+
+    void writeData(const uint8_t *data, size_t length) override
+    {
+        recorder.recordData(length);
+        interface.writeData(data, length);
+    }
+
+    bool readData(uint8_t *data, size_t length) override
+    {
+        recorder.recordRead();
+        return interface.readData(data, length);
+    }
+
+    void waitUntilIdle() override
+    {
+        const uint32_t startUs = recorder.now();
+        interface.waitUntilIdle();
+        recorder.recordIdleWait(startUs);
+    }
+
+    bool isBusy() override
+    {
+        return interface.isBusy();
+    }
+
+    void startWriteData(const uint8_t *data, size_t length) override
+    {
+        recorder.recordData(length);
+        interface.startWriteData(data, length);
+    }
+
+    bool isTransferComplete() override
+    {
+        return interface.isTransferComplete();
+    }
+
+    void waitForTransfer() override
+    {
+        const uint32_t startUs = recorder.now();
+        interface.waitForTransfer();
+        recorder.recordTransferWait(startUs);
+    }
+
+private:
+    SSDAsyncInterface &interface;
+    Recorder &recorder;
+
+    static void forwardCompletion(void *context)
+    {
+        static_cast<InstrumentedAsyncInterface *>(context)->notifyTransferComplete();
+    }
+};
+} // namespace instrumentation
+
+#if defined(SSD_DISPLAY_DRIVER_INSTRUMENTATION)
+/// Marks the rest of the enclosing scope as \p operation (an instrumentation::Operation) of the
+/// recorder of the driver.
+#define SSD_INSTRUMENT_OPERATION(operation)                                                        \
+    instrumentation::ScopedOperation instrumentedOperation(recorder, operation)
+#else
+#define SSD_INSTRUMENT_OPERATION(operation) static_cast<void>(0)
+#endif
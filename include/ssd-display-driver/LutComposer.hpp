@@ -0,0 +1,183 @@
+#pragma once
+
+#include "LutTiming.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Compile-time composition of SSD1675a/SSD1680 waveforms (LUTs) from typed phase descriptions.
+///
+/// The composers emit the exact byte layout of the controller, so the result can be passed to
+/// the LUT register like the hand-packed tables. Invalid tables do not compile if composed into
+/// a constexpr variable, e.g.
+///
+///     constexpr auto VSS = lut_composer::Voltage::VSS;
+///     constexpr auto VSL = lut_composer::Voltage::VSL;
+///     constexpr auto VSH1 = lut_composer::Voltage::VSH1;
+///     constexpr auto Idle = lut_composer::Idle;
+///
+///     constexpr auto Fast = lut_composer::composeSSD1680<1>({{
+///         {{{{VSS, VSS, VSS, VSS}, {VSL, VSS, VSS, VSS}, {VSH1, VSS, VSS, VSS}, Idle, Idle}},
+///          {12, 0, 0, 0}},
+///     }});
+///     static_assert(lut_composer::durationUs(Fast) < 500'000);
+namespace lut_composer
+{
+/// Source voltage of a sub phase. For LUT4, the levels are applied to VCOM instead.
+enum class Voltage : uint8_t
+{
+    VSS = 0b00,  //!< 0 V
+    VSH1 = 0b01, //!< 15 V
+    VSL = 0b10,  //!< -15 V
+    VSH2 = 0b11  //!< 5 V
+};
+
+/// LUT0 .. LUT3 are selected per pixel by its BW and red RAM bits, LUT4 drives VCOM.
+constexpr size_t NumberOfLuts = 5;
+
+/// Frame rate setting of the SSD1680 used by the LUTs of this library, 50 Hz.
+constexpr uint8_t DefaultFrameRate = 4;
+
+/// Voltages of the sub phases A, B, C and D.
+using SubPhases = std::array<Voltage, 4>;
+
+constexpr SubPhases Idle = {Voltage::VSS, Voltage::VSS, Voltage::VSS, Voltage::VSS};
+
+struct Phase
+{
+    std::array<SubPhases, NumberOfLuts> luts; //!< Voltages of LUT0 .. LUT4.
+    std::array<uint8_t, 4> frames;            //!< Frames of the sub phases A, B, C and D.
+    uint8_t repeats = 0;                      //!< The phase runs repeats + 1 times.
+    uint8_t repeatsAB = 0; //!< SSD1680 only, sub phases A and B run repeatsAB + 1 times.
+    uint8_t repeatsCD = 0; //!< SSD1680 only, sub phases C and D run repeatsCD + 1 times.
+    uint8_t frameRate = DefaultFrameRate; //!< SSD1680 only, see lut_timing::frameRateMilliHz().
+};
+
+namespace detail
+{
+/// Not constexpr, so composing an invalid table in a constant expression does not compile.
+/// The reason is shown by the compiler as argument of this call.
+inline void invalidLut(const char *reason)
+{
+    (void)reason;
+}
+
+constexpr void check(bool condition, const char *reason)
+{
+    if (!condition)
+        invalidLut(reason);
+}
+
+template <size_t Size, size_t NumberOfPhases>
+constexpr std::array<uint8_t, Size> compose(const std::array<Phase, NumberOfPhases> &phases,
+                                            const lut_timing::Layout &layout)
+{
+    std::array<uint8_t, Size> lut{};
+
+    // unused phases of the SSD1680 keep the default frame rate
+    for (size_t i = 0; layout.frameRateOffset != 0 && i < layout.phases / 2; ++i)
+        lut[layout.frameRateOffset + i] = (DefaultFrameRate << 4) | DefaultFrameRate;
+
+    for (size_t p = 0; p < NumberOfPhases; ++p)
+    {
+        const Phase &phase = phases[p];
+
+        for (size_t l = 0; l < NumberOfLuts; ++l)
+        {
+            uint8_t value = 0;
+
+            for (size_t s = 0; s < 4; ++s)
+                value |= static_cast<uint8_t>(phase.luts[l][s]) << (6 - 2 * s);
+
+            lut[l * layout.phases + p] = value;
+        }
+
+        const size_t timing = NumberOfLuts * layout.phases + p * layout.bytesPerPhase;
+
+        if (layout.hasStateRepeats)
+        {
+            lut[timing + 0] = phase.frames[0];
+            lut[timing + 1] = phase.frames[1];
+            lut[timing + 2] = phase.repeatsAB;
+            lut[timing + 3] = phase.frames[2];
+            lut[timing + 4] = phase.frames[3];
+            lut[timing + 5] = phase.repeatsCD;
+            lut[timing + 6] = phase.repeats;
+        }
+        else
+        {
+            check(phase.repeatsAB == 0 && phase.repeatsCD == 0,
+                  "sub phase repeats are supported by SSD1680 only");
+
+            for (size_t s = 0; s < 4; ++s)
+                lut[timing + s] = phase.frames[s];
+
+            lut[timing + 4] = phase.repeats;
+        }
+
+        if (layout.frameRateOffset != 0)
+        {
+            check(phase.frameRate <= 0xF, "frame rate setting exceeds 4 bits");
+
+            uint8_t &frameRate = lut[layout.frameRateOffset + p / 2];
+
+            if (p % 2 == 0)
+                frameRate = (frameRate & 0x0F) | (phase.frameRate << 4);
+            else
+                frameRate = (frameRate & 0xF0) | (phase.frameRate & 0x0F);
+        }
+        else
+            check(phase.frameRate == DefaultFrameRate, "frame rates are supported by SSD1680 only");
+    }
+
+    check(lut_timing::totalFrames(lut.data(), layout) != 0, "waveform without frames");
+
+    return lut;
+}
+} // namespace detail
+
+/// Composes a 70 byte SSD1675a LUT, unused phases are left empty.
+template <size_t NumberOfPhases>
+constexpr std::array<uint8_t, lut_timing::SSD1675a.size>
+composeSSD1675a(const std::array<Phase, NumberOfPhases> &phases)
+{
+    static_assert(NumberOfPhases <= lut_timing::SSD1675a.phases, "SSD1675a has 7 phases");
+    return detail::compose<lut_timing::SSD1675a.size>(phases, lut_timing::SSD1675a);
+}
+
+/// Composes a 153 byte SSD1680 LUT, unused phases are left empty and the gate scan bytes 0.
+template <size_t NumberOfPhases>
+constexpr std::array<uint8_t, lut_timing::SSD1680.size>
+composeSSD1680(const std::array<Phase, NumberOfPhases> &phases)
+{
+    static_assert(NumberOfPhases <= lut_timing::SSD1680.phases, "SSD1680 has 12 phases");
+    return detail::compose<lut_timing::SSD1680.size>(phases, lut_timing::SSD1680);
+}
+
+/// Compares two LUTs in constant expressions, e.g. a composed and a hand-packed one.
+/// std::array::operator== is constexpr since C++20 only.
+template <size_t Size>
+constexpr bool isEqual(const std::array<uint8_t, Size> &lhs, const std::array<uint8_t, Size> &rhs)
+{
+    for (size_t i = 0; i < Size; ++i)
+        if (lhs[i] != rhs[i])
+            return false;
+
+    return true;
+}
+
+/// Duration of a SSD1675a waveform in microseconds, i.e. the busy time of a refresh.
+/// \param frameRate Frame rate in mHz, the SSD1675a LUT contains none.
+constexpr uint64_t durationUs(const std::array<uint8_t, lut_timing::SSD1675a.size> &lut,
+                              uint32_t frameRate = lut_timing::DefaultFrameRateMilliHz)
+{
+    return lut_timing::durationUs(lut.data(), lut_timing::SSD1675a, frameRate);
+}
+
+/// Duration of a SSD1680 waveform in microseconds, using the frame rates of the LUT.
+constexpr uint64_t durationUs(const std::array<uint8_t, lut_timing::SSD1680.size> &lut)
+{
+    return lut_timing::durationUs(lut.data(), lut_timing::SSD1680);
+}
+} // namespace lut_composer
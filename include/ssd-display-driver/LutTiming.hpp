@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Duration of the waveforms (LUTs) of SSD1675a and SSD1680, derived from the LUT bytes.
+namespace lut_timing
+{
+/// Byte layout of a waveform.
+struct Layout
+{
+    size_t size;             //!< Size of the LUT in bytes.
+    size_t phases;           //!< Number of phases (groups).
+    size_t bytesPerPhase;    //!< Timing bytes per phase.
+    bool hasStateRepeats;    //!< Timing contains repeats for the sub phases AB and CD.
+    size_t frameRateOffset;  //!< Offset of the frame rate bytes, 0 if there are none.
+};
+
+/// 70 bytes: 5 x 7 voltage bytes, then TPA TPB TPC TPD RP per phase.
+constexpr Layout SSD1675a{70, 7, 5, false, 0};
+
+/// 153 bytes: 5 x 12 voltage bytes, then TPA TPB SRAB TPC TPD SRCD RP per phase,
+/// 6 frame rate bytes (one nibble per phase) and 3 gate scan bytes.
+constexpr Layout SSD1680{153, 12, 7, true, 144};
+
+/// Frame rate used for layouts without frame rate bytes.
+constexpr uint32_t DefaultFrameRateMilliHz = 50'000;
+
+/// Approximates the frame rate of a SSD1680 frame rate setting, in mHz.
+/// The setting 4 used by all LUTs of this library corresponds to 50 Hz.
+constexpr uint32_t frameRateMilliHz(uint8_t setting)
+{
+    return 25'000 + (setting & 0xF) * 6'250;
+}
+
+/// Number of frames phase \p phase takes, including all its repeats.
+/// A repeat count of n runs the phase (or sub phase) n + 1 times.
+constexpr uint32_t phaseFrames(const uint8_t *lut, const Layout &layout, size_t phase)
+{
+    const uint8_t *timing = lut + 5 * layout.phases + phase * layout.bytesPerPhase;
+
+    uint32_t frames = 0;
+
+    if (layout.hasStateRepeats)
+    {
+        frames = (timing[0] + timing[1]) * (timing[2] + 1u);
+        frames += (timing[3] + timing[4]) * (timing[5] + 1u);
+        return frames * (timing[6] + 1u);
+    }
+
+    frames = timing[0] + timing[1] + timing[2] + timing[3];
+    return frames * (timing[4] + 1u);
+}
+
+/// Number of frames of the whole waveform.
+constexpr uint32_t totalFrames(const uint8_t *lut, const Layout &layout)
+{
+    uint32_t frames = 0;
+
+    for (size_t phase = 0; phase < layout.phases; ++phase)
+        frames += phaseFrames(lut, layout, phase);
+
+    return frames;
+}
+
+/// Duration of the whole waveform in microseconds.
+/// \param frameRate Frame rate in mHz for layouts without frame rate bytes.
+constexpr uint64_t durationUs(const uint8_t *lut, const Layout &layout,
+                              uint32_t frameRate = DefaultFrameRateMilliHz)
+{
+    uint64_t duration = 0;
+
+    for (size_t phase = 0; phase < layout.phases; ++phase)
+    {
+        uint32_t rate = frameRate;
+
+        if (layout.frameRateOffset != 0)
+        {
+            const uint8_t frameRateByte = lut[layout.frameRateOffset + phase / 2];
+            rate = frameRateMilliHz(phase % 2 == 0 ? frameRateByte >> 4 : frameRateByte);
+        }
+
+        if (rate != 0)
+            duration += uint64_t{phaseFrames(lut, layout, phase)} * 1'000'000'000 / rate;
+    }
+
+    return duration;
+}
+} // namespace lut_timing
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "BitTranspose.hpp"
+#include "ImageCompression.hpp"
+#include "Instrumentation.hpp"
+#include "SSDAsyncInterface.hpp"
 #include "SSDInterface.hpp"
 #include "display-renderer/IRenderTarget.hpp"
 
+#include <array>
+#include <initializer_list>
+
 /// Display driver interface for the SSD1305 OLED controller IC.
 class SSD1305 : public IRenderTarget
 {
@@ -61,8 +68,111 @@ public:
         x0_83  //!< 0.83 * Vcc
     };
 
+    enum class ScrollDirection
+    {
+        Right, //!< Content moves towards the higher columns.
+        Left   //!< Content moves towards the lower columns.
+    };
+
+    enum class PixelOperation
+    {
+        Set,   //!< Pixels of the mask are turned on.
+        Clear, //!< Pixels of the mask are turned off.
+        Toggle //!< Pixels of the mask are inverted.
+    };
+
+    /// Time between two scroll steps, in frames. Intervals not supported by the controller are
+    /// rounded to the nearest supported one: SSD1305 supports 2, 3, 4, 5, 6, 32, 64 and 128
+    /// frames, SSD1306 supports 2, 3, 4, 5, 25, 64, 128 and 256 frames.
+    enum class ScrollInterval
+    {
+        Frames2,
+        Frames3,
+        Frames4,
+        Frames5,
+        Frames6,
+        Frames25,
+        Frames32,
+        Frames64,
+        Frames128,
+        Frames256
+    };
+
+    /// Controller the commands are encoded for. Both are compatible, except for the charge pump
+    /// and the framing of the scroll setup.
+    enum class Variant : uint8_t
+    {
+        SSD1305, //!< 132 columns, scroll setup with column offset.
+        SSD1306  //!< 128 columns, scroll setup with dummy bytes and charge pump.
+    };
+
+    /// Settings of the controller kept in the register shadow, in the order restore() replays
+    /// them.
+    enum class Register : uint8_t
+    {
+        MultiplexRatio,
+        DisplayOffset,
+        DisplayStartLine,
+        SegmentRemap,
+        ComOutputMode,
+        ComPinConfig,
+        DisplayClockDivide,
+        PrechargingPeriod,
+        VcomhDeselectLevel,
+        Contrast,
+        Brightness,
+        Lut,
+        DimMode,
+        AreaColorModeAndPowerMode,
+        ChargePump,
+        AddressingMode,
+        ColumnWindow,
+        PageWindow,
+        EntireDisplayOn,
+        InverseDisplay,
+        VerticalScrollArea,
+        ScrollSetup,
+        DisplayState,
+        ScrollActivation,
+        NumberOfRegisters
+    };
+
+    /// Command bytes last written for each register, see snapshot() and restore().
+    struct RegisterSnapshot
+    {
+        static constexpr size_t NumberOfRegisters =
+            static_cast<size_t>(Register::NumberOfRegisters);
+        static constexpr size_t MaxCommandLength = 7;
+
+        std::array<std::array<uint8_t, MaxCommandLength>, NumberOfRegisters> commands{};
+
+        /// Number of command bytes per register, 0 if the register was not written yet.
+        std::array<uint8_t, NumberOfRegisters> lengths{};
+
+        /// Controller the commands were encoded for.
+        Variant variant = Variant::SSD1305;
+    };
+
+    /// Renders one page of the image into \p pageBuffer, \p width bytes in GDDRAM layout
+    /// (LSB being the top pixel).
+    using PageRenderer = void (*)(void *context, uint8_t page, uint8_t *pageBuffer,
+                                  size_t width);
+
     explicit SSD1305(SSDInterface &interface) : di(interface){};
 
+    /// Enables submitImageAsync() to transfer images in the background.
+    explicit SSD1305(SSDAsyncInterface &interface) : di(interface), asyncDi(&interface){};
+
+#if defined(SSD_DISPLAY_DRIVER_INSTRUMENTATION)
+    /// Accounts the bus traffic of the image and pixel operations to their operation types.
+    /// \param instrumentationRecorder Recorder shared with the instrumented interface, nullptr
+    ///                                to disable.
+    void setInstrumentation(instrumentation::Recorder *instrumentationRecorder)
+    {
+        recorder = instrumentationRecorder;
+    }
+#endif
+
     void setColumnStartAddress(uint8_t addr);
 
     void setMemoryAddressingMode(AddressingMode mode);
@@ -181,10 +291,51 @@ public:
     /// No operation command.
     void nop();
 
-    /// Only for SSD1306
+    /// Enables the internal charge pump. Only for SSD1306, ignored by SSD1305.
     void setChargePump(bool enable);
 
-    // TODO: Scrolling
+    /// Sets up continuous horizontal scrolling of a range of pages.
+    ///
+    /// A running scroll is deactivated first, see deactivateScroll(). The scrolling starts with
+    /// activateScroll().
+    /// \param direction    Scroll direction.
+    /// \param startPage    First page to scroll, from 0 to 7.
+    /// \param endPage      Last page to scroll, from \p startPage to 7.
+    /// \param interval     Time between two scroll steps.
+    /// \param columnOffset Columns scrolled per step, 0 for no horizontal scrolling. Ignored by
+    ///                     SSD1306, which always scrolls one column per step.
+    void setupHorizontalScroll(ScrollDirection direction, uint8_t startPage, uint8_t endPage,
+                               ScrollInterval interval, uint8_t columnOffset = 1);
+
+    /// Sets up continuous vertical and horizontal scrolling.
+    ///
+    /// The pages \p startPage to \p endPage scroll horizontally, the rows of the vertical
+    /// scroll area (see setVerticalScrollArea()) scroll vertically.
+    /// \param verticalOffset Rows scrolled per step, from 1 to 63.
+    /// \see setupHorizontalScroll()
+    void setupDiagonalScroll(ScrollDirection direction, uint8_t startPage, uint8_t endPage,
+                             ScrollInterval interval, uint8_t verticalOffset,
+                             uint8_t columnOffset = 1);
+
+    /// Sets the rows scrolled vertically by the diagonal scroll.
+    /// \param fixedRows  Number of rows at the top, which do not scroll.
+    /// \param scrollRows Number of rows below, which scroll.
+    void setVerticalScrollArea(uint8_t fixedRows, uint8_t scrollRows);
+
+    /// Starts the scrolling set up before.
+    ///
+    /// The controller must not be accessed for RAM data while scrolling, so every image or
+    /// pixel data written afterwards deactivates the scrolling first.
+    void activateScroll();
+
+    /// Stops the scrolling. The scrolled content is not written back into the GDDRAM, so the
+    /// next image is sent completely, even with differential updates.
+    void deactivateScroll();
+
+    bool isScrollActive() const
+    {
+        return isScrolling;
+    }
 
     /// Draws 8 data bits onto the display.
     ///
@@ -206,12 +357,285 @@ public:
 
     void submitImage(const uint8_t *image, size_t length) override;
 
+    /// Writes \p length bytes into a single page, using one narrow column/page window, or the
+    /// page and column start pointers in page addressing mode.
+    /// \param page   Page relative to the page window (start page in page addressing mode).
+    /// \param column Column relative to the column window (start column in page addressing mode).
+    void drawPage(uint8_t page, uint8_t column, const uint8_t *data, size_t length);
+
+    /// Converts a row-major image page by page and sends it, without a page-major copy of the
+    /// whole image. Uses differential updates, if enabled for images of this size.
+    /// \param image  Row-major image, 8 pixels per byte with the MSB being the leftmost pixel.
+    /// \param width  Image width in pixels, up to 132.
+    /// \param height Image height in pixels.
+    /// \param mirror Mirroring applied during the conversion, e.g. to match a remapped panel.
+    void submitRowMajorImage(const uint8_t *image, uint8_t width, uint8_t height,
+                             bit_transpose::Mirror mirror = bit_transpose::Mirror::None);
+
+    /// Pulls the image page by page from \p renderer and sends it, without an image buffer.
+    ///
+    /// Two page buffers on the stack are used alternately. With an SSDAsyncInterface, the next
+    /// page is rendered while the previous one is transferred. Uses differential updates, if
+    /// enabled for images of this size. Returns after the last page has been transferred.
+    /// \param width         Image width in pixels, up to 132.
+    /// \param numberOfPages Image height in pages of 8 pixels.
+    void submitStreamedImage(PageRenderer renderer, void *context, uint8_t width,
+                             uint8_t numberOfPages);
+
+    /// Expands an image compressed by image_compression::compress() page by page while sending
+    /// it, see submitStreamedImage(). Pages missing in the data are drawn blank.
+    /// \param data          Compressed page-major image, e.g. in flash.
+    /// \param length        Length of the compressed data.
+    /// \param width         Image width in pixels, up to 132.
+    /// \param numberOfPages Image height in pages of 8 pixels.
+    void submitCompressedImage(const uint8_t *data, size_t length, uint8_t width,
+                               uint8_t numberOfPages);
+
+    /// Starts sending the image in the background and returns before the transfer has completed.
+    ///
+    /// The driver owns \p image until the transfer has completed. Every following call writing
+    /// to the bus waits for it first, so the image is free again once the next
+    /// submitImageAsync() has returned. Use DoubleBuffer for rendering while transferring.
+    /// The image is always sent completely, but the shadow of differential updates is kept
+    /// up to date. Without an SSDAsyncInterface, the image is sent using submitImage().
+    /// Inside a transaction, the commands collected so far are sent before the image.
+    void submitImageAsync(const uint8_t *image, size_t length);
+
+    /// \return True if no image transfer started by submitImageAsync() is running.
+    bool isImageTransferComplete();
+
+    /// Blocks until the image transfer started by submitImageAsync() has completed.
+    void waitForImageTransfer();
+
+    /// Modifies the pixels of \p mask in one GDDRAM byte in place, without a host framebuffer.
+    ///
+    /// The byte is read back in read-modify-write mode, if the interface supports reading (see
+    /// SSDInterface::readData()). Otherwise, it is taken from the shadow of the differential
+    /// updates, if valid, or from a small cache of the bytes modified before. Bytes missing in
+    /// the cache are assumed to be cleared, so without a read path, the GDDRAM has to be
+    /// cleared before and only be changed by these functions.
+    ///
+    /// The cache is direct-mapped and holds a working set like two pages of 16 columns. Without
+    /// a read path or a valid shadow, it is the only copy of the modified bytes, so a byte
+    /// still having pixels set is never evicted: a modification colliding with it is rejected
+    /// and counted, see rejectedPixelUpdates().
+    /// \param page   Page relative to the page window (start page in page addressing mode).
+    /// \param column Column relative to the column window (start column in page addressing mode).
+    /// \param mask   Pixels to be changed, LSB being the top pixel.
+    /// \return False if the modification was rejected, the GDDRAM is left unchanged then.
+    bool modifyByte(uint8_t page, uint8_t column, uint8_t mask, PixelOperation operation);
+
+    /// Modifies a single pixel, see modifyByte().
+    /// \param x Column relative to the column window.
+    /// \param y Row relative to the page window.
+    bool modifyPixel(uint8_t x, uint8_t y, PixelOperation operation);
+
+    bool setPixel(uint8_t x, uint8_t y)
+    {
+        return modifyPixel(x, y, PixelOperation::Set);
+    }
+
+    bool clearPixel(uint8_t x, uint8_t y)
+    {
+        return modifyPixel(x, y, PixelOperation::Clear);
+    }
+
+    bool togglePixel(uint8_t x, uint8_t y)
+    {
+        return modifyPixel(x, y, PixelOperation::Toggle);
+    }
+
+    /// Enables differential updates in submitImage(const uint8_t *, size_t).
+    ///
+    /// The driver keeps a copy of the last transmitted image in \p shadowBuffer and only sends
+    /// the column spans of each page which differ from it, using narrow column/page windows.
+    /// The first image after enabling (or after invalidateShadow()) is sent completely.
+    /// Images with a length other than \p length are always sent completely.
+    /// The images have to be page-major, as used in horizontal addressing mode.
+    /// \param shadowBuffer Buffer of \p length bytes, owned by the caller while enabled.
+    /// \param length       Length of the images passed to submitImage(), in bytes.
+    /// \param width        Number of columns per page of the images, from 1 to 132.
+    void enableDifferentialUpdate(uint8_t *shadowBuffer, size_t length, uint8_t width);
+
+    /// Disables differential updates, submitImage() sends the whole image again.
+    void disableDifferentialUpdate();
+
+    /// Marks the shadow copy as outdated, so the next image is sent completely.
+    /// Needs to be called if the GDDRAM was changed bypassing submitImage(), e.g. by draw().
+    void invalidateShadow();
+
     void resetColumnStartAddress();
     void resetPageStartAddress();
 
+    /// \return Settings written since construction or the last invalidateRegisters().
+    const RegisterSnapshot &snapshot() const
+    {
+        return registers;
+    }
+
+    /// Writes all settings of \p registerSnapshot to the controller, e.g. after a reset or a
+    /// brown-out. Only the registers which were written before are replayed, each with a single
+    /// command. The charge pump and scroll settings of a snapshot taken from the other variant
+    /// are skipped, since their encoding differs. The commands are collected in a transaction,
+    /// which is sent early each time TransactionCapacity bytes are collected, so a snapshot of all
+    /// registers (up to 55 command bytes) takes two SSDInterface::writeCommands() calls. The
+    /// GDDRAM content is considered lost, so the next image is sent completely.
+    void restore(const RegisterSnapshot &registerSnapshot);
+
+    /// Forgets the register shadow, so all following settings are written again.
+    void invalidateRegisters();
+
+    /// \return Number of setter calls dropped since the value was written already.
+    size_t droppedRegisterWrites() const
+    {
+        return numberOfDroppedWrites;
+    }
+
+    /// \return Number of modifyByte() calls rejected since they would have evicted a modified
+    /// byte from the byte cache.
+    size_t rejectedPixelUpdates() const
+    {
+        return numberOfRejectedPixelUpdates;
+    }
+
+    /// Starts collecting command bytes instead of writing them one by one.
+    ///
+    /// Commands issued by any setter until endTransaction() are sent with a single
+    /// SSDInterface::writeCommands() call. The collected commands are sent early if the buffer
+    /// is full or before pixel data is written. Image updates append their pixel data to the
+    /// transaction instead, so the commands and the data are sent with a single
+    /// SSDInterface::writeSegments() call. Transactions can be nested, only the outermost
+    /// endTransaction() sends the commands.
+    ///
+    /// The pixel data is not copied: image and page buffers passed to submitImage(), drawPage()
+    /// etc. must stay valid and unmodified until the outermost endTransaction(), or until
+    /// flushTransaction() before a buffer is reused.
+    void beginTransaction();
+
+    /// Sends the collected command bytes and stops collecting.
+    void endTransaction();
+
+    /// Sends the commands and pixel data collected so far, keeping the transaction open.
+    void flushTransaction();
+
 protected:
+    /// For the compatible controllers, see SSD1306.
+    SSD1305(SSDInterface &interface, Variant variant) : di(interface), variant(variant)
+    {
+        registers.variant = variant;
+    };
+
+    SSD1305(SSDAsyncInterface &interface, Variant variant)
+        : di(interface), asyncDi(&interface), variant(variant)
+    {
+        registers.variant = variant;
+    };
+
+    static constexpr size_t TransactionCapacity = 32;
+    static constexpr size_t SegmentCapacity = 16;
+    static constexpr size_t MaxColumns = 132;
+    static constexpr size_t ByteCacheSize = 32;
+
+    /// GDDRAM byte modified by modifyByte(), used if the interface cannot read.
+    struct CachedByte
+    {
+        uint8_t page;
+        uint8_t column;
+        uint8_t value;
+        bool isValid;
+    };
+
     SSDInterface &di;
+    SSDAsyncInterface *asyncDi = nullptr;
+    Variant variant = Variant::SSD1305;
+#if defined(SSD_DISPLAY_DRIVER_INSTRUMENTATION)
+    instrumentation::Recorder *recorder = nullptr;
+#endif
+    bool isImageTransferRunning = false;
+    bool isScrolling = false;
+
+    std::array<uint8_t, TransactionCapacity> transactionBuffer{};
+    size_t transactionLength = 0;
+    uint8_t transactionDepth = 0;
+
+    /// Segments of the open transaction not sent yet, see appendData().
+    std::array<SSDInterface::Segment, SegmentCapacity> segments{};
+    size_t numberOfSegments = 0;
+
+    /// Length of the part of the transaction buffer referenced by segments.
+    size_t segmentedLength = 0;
+
+    uint8_t columnStartAddress = 0;
+    uint8_t pageStartAddress = 0;
+
+    AddressingMode addressingMode = AddressingMode::Page;
+
+    /// Column and page window as set by the user, restored after differential updates.
+    uint8_t columnWindowStart = 0;
+    uint8_t columnWindowEnd = 131;
+    uint8_t pageWindowStart = 0;
+    uint8_t pageWindowEnd = 7;
+    bool isWindowNarrowed = false;
+
+    /// Register shadow, a setter writing the value held by it is dropped.
+    RegisterSnapshot registers{};
+    size_t numberOfDroppedWrites = 0;
+
+    uint8_t *shadow = nullptr;
+    size_t shadowLength = 0;
+    uint8_t shadowWidth = 0;
+    bool isShadowValid = false;
+
+    /// Slot of a GDDRAM byte in the byte cache. Two pages of 16 columns, e.g. a cursor or an
+    /// icon of 16x16 pixels, are mapped without collisions.
+    static constexpr size_t byteCacheIndex(uint8_t page, uint8_t column)
+    {
+        return (column + page * (ByteCacheSize / 2)) % ByteCacheSize;
+    }
+
+    /// Cleared once SSDInterface::readData() reported that it cannot read.
+    bool isReadSupported = true;
+
+    /// Direct-mapped cache of the bytes modified by modifyByte().
+    std::array<CachedByte, ByteCacheSize> byteCache{};
+    size_t numberOfRejectedPixelUpdates = 0;
+
+    void submitFullImage(const uint8_t *image, size_t length);
+
+    /// Restores the user's window and moves the address pointers to its origin.
+    void prepareFullImage();
+    void submitDifferentialImage(const uint8_t *image);
+    void submitDifferentialPage(size_t page, const uint8_t *newRow);
+
+    /// Writes \p length bytes to \p page, starting at \p column (relative to the image origin).
+    /// The data is appended to the transaction, see appendData().
+    void drawSpan(uint8_t page, uint8_t column, const uint8_t *data, size_t length);
+
+    /// Moves the address pointer to \p column of \p page, with a window of \p length columns.
+    void moveToSpan(uint8_t page, uint8_t column, size_t length);
+
+    /// \return GDDRAM byte at the position, read back or taken from the shadow or cache.
+    uint8_t readByte(uint8_t page, uint8_t column, bool &isReadModifyWrite);
+    void invalidateByteCache();
+
+    /// Stores the command bytes of a register in the register shadow.
+    /// \return False if the register held these bytes already.
+    bool storeRegister(Register reg, std::initializer_list<uint8_t> bytes);
+
+    /// Writes the command bytes of a register, unless the register shadow holds them already.
+    void writeRegister(Register reg, std::initializer_list<uint8_t> bytes);
+
+    /// Deactivates the scrolling and writes the scroll setup.
+    void writeScrollSetup(std::initializer_list<uint8_t> bytes);
+
+    /// Writes the command directly or appends it to the open transaction.
+    void writeCommand(uint8_t cmd);
+
+    /// Like draw(), but inside a transaction the data is not copied. It is sent after the
+    /// commands collected so far as SSDInterface::Segment, so it has to stay valid until the
+    /// transaction is flushed.
+    void appendData(const uint8_t *data, size_t length);
 
-    uint8_t columnStartAddress;
-    uint8_t pageStartAddress;
+    /// Adds a segment, sending the collected ones first if the list is full.
+    void appendSegment(SSDInterface::Segment::Type type, const uint8_t *data, size_t length);
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "SSD1305.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Scrolling text console for SSD1305/SSD1306 displays.
+///
+/// The 8 pages of the GDDRAM are used as a ring of text lines. A new line is written into the
+/// page following the newest line with a single narrow page window, then the display start line
+/// is moved so that it becomes the bottom line of the display. Lines scroll up without redrawing
+/// the older ones. The console owns the display start line; the column and page window (start
+/// addresses in page addressing mode) have to start at 0.
+class SSD1305Console
+{
+public:
+    /// Monospaced font with glyphs of 8 pixel height, stored column by column like the GDDRAM,
+    /// LSB being the top pixel.
+    struct Font
+    {
+        const uint8_t *glyphs; //!< glyphWidth bytes per character, from first to last.
+        uint8_t glyphWidth;    //!< Columns per glyph, including spacing.
+        char first;            //!< First character of the font.
+        char last;             //!< Last character of the font.
+    };
+
+    /// Pages of the GDDRAM, forming the ring of lines.
+    static constexpr uint8_t NumberOfPages = 8;
+
+    /// Columns of the SSD1305 GDDRAM, the maximum line width.
+    static constexpr uint8_t MaxWidth = 132;
+
+    /// The console starts with the start line set by the display, usually 0; call clear() to
+    /// start on a blank display.
+    /// \param display      Display to write to.
+    /// \param font         Font used by writeLine(const char *).
+    /// \param visibleLines Number of lines shown by the display, e.g. 8 for 64 rows, 4 for 32.
+    /// \param width        Columns per line, larger values are clamped to MaxWidth.
+    SSD1305Console(SSD1305 &display, const Font &font, uint8_t visibleLines = 8,
+                   uint8_t width = 128)
+        : display(display), font(font), visibleLines(std::min(visibleLines, NumberOfPages)),
+          width(std::min(width, MaxWidth)){};
+
+    /// Clears all lines and moves the first line to the top of the display.
+    void clear();
+
+    /// Appends a line of text. Text beyond the width and characters missing in the font are
+    /// left blank.
+    void writeLine(const char *text);
+
+    /// Appends a line of pre-rendered page data, e.g. an icon or a bar graph.
+    /// \param pageData Page data of width bytes.
+    void writeLine(const uint8_t *pageData);
+
+    /// \return Number of lines written since construction or the last clear().
+    size_t numberOfLines() const
+    {
+        return lineCount;
+    }
+
+private:
+    SSD1305 &display;
+    Font font;
+    uint8_t visibleLines;
+    uint8_t width;
+
+    size_t lineCount = 0;
+    std::array<uint8_t, MaxWidth> lineBuffer{}; //!< Rendered text line.
+
+    /// Writes the line into the next page of the ring and scrolls it into view.
+    void appendLine(const uint8_t *pageData);
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "SSDInterface.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Host-side emulation of a SSD1305/SSD1306 controller for testing drivers without hardware.
+///
+/// Decodes the command stream into the controller state and the GDDRAM contents and records
+/// every byte transferred on the bus. Traffic is accumulated per frame, see markFrame().
+/// Host only, it is built into the ssd-display-driver-emulators library.
+class SSD1305Emulator : public SSDInterface
+{
+public:
+    static constexpr auto Columns = 132;
+    static constexpr auto Pages = 8;
+    static constexpr auto Rows = Pages * 8;
+
+    enum class Variant
+    {
+        SSD1305, //!< 132 columns, scroll setup without dummy bytes.
+        SSD1306  //!< 128 columns, scroll setup with dummy bytes.
+    };
+
+    enum class Bus
+    {
+        Spi,     //!< 4-wire SPI, 8 clock cycles per byte.
+        I2c,     //!< I2C, address and control byte per transaction, 9 clock cycles per byte.
+        Parallel //!< 6800/8080 parallel, 1 cycle per byte, the only bus able to read.
+    };
+
+    enum class ByteType : uint8_t
+    {
+        Command,
+        Data,
+        Read //!< Read by readData(), including the dummy byte.
+    };
+
+    struct TraceEntry
+    {
+        ByteType type;
+        uint8_t value;
+        uint32_t transaction; //!< Index of the interface call the byte was written by.
+    };
+
+    struct Traffic
+    {
+        size_t commandBytes = 0;
+        size_t dataBytes = 0;
+        size_t readBytes = 0;
+        size_t transactions = 0;
+        size_t wireBytes = 0;      //!< Bytes on the wire, including I2C address and control bytes.
+        uint64_t transferTimeNs = 0; //!< Estimated time on the bus.
+    };
+
+    enum class AddressingMode : uint8_t
+    {
+        Horizontal = 0b00,
+        Vertical = 0b01,
+        Page = 0b10
+    };
+
+    /// \param variant Controller to be emulated.
+    /// \param bus     Bus used for the transfer time estimation.
+    /// \param clockHz Bus clock used for the transfer time estimation.
+    explicit SSD1305Emulator(Variant variant = Variant::SSD1305, Bus bus = Bus::Spi,
+                             uint32_t clockHz = 8'000'000);
+
+    void writeCommand(uint8_t cmd) override;
+    void writeCommands(const uint8_t *cmds, size_t length) override;
+    void writeData(uint8_t data) override;
+    void writeData(const uint8_t *data, size_t length) override;
+
+    /// Records the segments as one transaction, like a chained DMA transfer. On I2C, every run of
+    /// segments of the same type is framed by address and control byte, as by SSDI2cInterface.
+    void writeSegments(const Segment *segments, size_t numberOfSegments) override;
+
+    /// Reads the GDDRAM at the address pointer, the first byte after a command or a write being
+    /// a dummy byte. The pointer advances with each byte, except in read-modify-write mode.
+    /// \return False unless the parallel bus is emulated, the serial buses cannot read.
+    bool readData(uint8_t *data, size_t length) override;
+
+    void waitUntilIdle() override{};
+
+    /// Sets the bus used for the transfer time estimation of all following transactions.
+    void setBus(Bus bus, uint32_t clockHz);
+
+    /// Resets the controller state and clears the GDDRAM, as done by the reset pin.
+    void reset();
+
+    /// Finishes the traffic statistics of the current frame and starts a new one.
+    void markFrame();
+
+    /// Traffic of all finished frames, see markFrame().
+    const std::vector<Traffic> &frames() const
+    {
+        return finishedFrames;
+    }
+
+    /// Traffic since the last call to markFrame().
+    const Traffic &currentFrame() const
+    {
+        return frameTraffic;
+    }
+
+    /// Traffic since construction or the last clearTrace().
+    const Traffic &totalTraffic() const
+    {
+        return total;
+    }
+
+    const std::vector<TraceEntry> &trace() const
+    {
+        return byteTrace;
+    }
+
+    /// Clears trace and traffic statistics, but keeps the controller state.
+    void clearTrace();
+
+    /// Raw GDDRAM byte at the given address.
+    uint8_t ram(uint8_t column, uint8_t page) const;
+
+    /// Pixel in GDDRAM coordinates.
+    bool ramPixel(uint8_t column, uint8_t row) const;
+
+    /// Pixel as visible on the panel, taking display state, start line, offset,
+    /// segment/COM remapping, inversion and entire display on into account.
+    bool displayPixel(uint8_t x, uint8_t y) const;
+
+    AddressingMode addressingMode() const
+    {
+        return mode;
+    }
+
+    uint8_t columnPointer() const
+    {
+        return column;
+    }
+
+    uint8_t pagePointer() const
+    {
+        return page;
+    }
+
+    uint8_t displayStartLine() const
+    {
+        return startLine;
+    }
+
+    uint8_t contrast() const
+    {
+        return contrastValue;
+    }
+
+    bool isDisplayOn() const
+    {
+        return displayOn;
+    }
+
+    bool isSegmentRemapped() const
+    {
+        return segmentRemap;
+    }
+
+    bool isComRemapped() const
+    {
+        return comRemap;
+    }
+
+    bool isReadModifyWrite() const
+    {
+        return readModifyWrite;
+    }
+
+    bool isScrollActive() const
+    {
+        return scrollActive;
+    }
+
+protected:
+    Variant variant;
+    Bus bus;
+    uint32_t clockHz;
+
+    std::array<std::array<uint8_t, Columns>, Pages> gddram{};
+
+    AddressingMode mode = AddressingMode::Page;
+    uint8_t column = 0;
+    uint8_t page = 0;
+    uint8_t columnStart = 0;
+    uint8_t columnEnd = Columns - 1;
+    uint8_t pageStart = 0;
+    uint8_t pageEnd = Pages - 1;
+
+    uint8_t startLine = 0;
+    uint8_t displayOffset = 0;
+    uint8_t multiplexRatio = Rows - 1;
+    uint8_t contrastValue = 0x80;
+    bool displayOn = false;
+    bool segmentRemap = false;
+    bool comRemap = false;
+    bool inverse = false;
+    bool entireDisplayOn = false;
+    bool scrollActive = false;
+
+    bool readModifyWrite = false;
+    uint8_t savedColumn = 0;
+    uint8_t savedPage = 0;
+    bool isDummyReadDue = true;
+
+    /// Command collecting its parameter bytes.
+    uint8_t pendingCommand = 0;
+    std::array<uint8_t, 6> parameters{};
+    size_t parameterCount = 0;
+    size_t expectedParameters = 0;
+
+    std::vector<TraceEntry> byteTrace;
+    std::vector<Traffic> finishedFrames;
+    Traffic frameTraffic;
+    Traffic total;
+    uint32_t transactionIndex = 0;
+
+    size_t numberOfParameters(uint8_t cmd) const;
+    void decodeCommand(uint8_t cmd);
+    void executeCommand();
+    void writeRam(uint8_t data);
+    void advancePointer();
+
+    /// Accounts one interface call with \p length payload bytes.
+    void recordTransaction(ByteType type, const uint8_t *data, size_t length);
+
+    /// Accounts \p length payload bytes of the current interface call, with the I2C address and
+    /// control byte if \p isFramed.
+    void recordBytes(ByteType type, const uint8_t *data, size_t length, bool isFramed);
+
+    /// Finishes the accounting of the current interface call.
+    void finishTransaction();
+};
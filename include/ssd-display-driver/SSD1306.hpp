@@ -4,11 +4,14 @@
 #include "SSDInterface.hpp"
 
 /// Display driver interface for the SSD1306 OLED controller IC.
-/// It is compatible to SSD1305, only the charge pump is added.
+/// It is compatible to SSD1305, only the charge pump is added and the scroll setup differs.
+/// SSD1305 encodes both for the variant given on construction, so the driver can be used through
+/// a reference to SSD1305 as well.
 class SSD1306 : public SSD1305
 {
 public:
-    explicit SSD1306(SSDInterface &interface) : SSD1305(interface){};
+    explicit SSD1306(SSDInterface &interface) : SSD1305(interface, Variant::SSD1306){};
 
-    void setChargePump(bool enable);
-};
\ No newline at end of file
+    /// Enables submitImageAsync() to transfer images in the background.
+    explicit SSD1306(SSDAsyncInterface &interface) : SSD1305(interface, Variant::SSD1306){};
+};
@@ -1,11 +1,21 @@
 #pragma once
 
+#include <array>
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "ColorPlanes.hpp"
+#include "ImageCompression.hpp"
+#include "Instrumentation.hpp"
+#include "LutTiming.hpp"
+#include "SSDAsyncInterface.hpp"
 #include "SSDInterface.hpp"
 #include "display-renderer/IRenderTarget.hpp"
 
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
 class SSD1675a : public IRenderTarget
 {
 public:
@@ -25,16 +35,168 @@ public:
         Red
     };
 
+    /// RAM planes of the controller.
+    enum class Plane : uint8_t
+    {
+        BlackWhite, //!< BW RAM, written by WriteBWRam.
+        Red         //!< Red RAM, written by WriteRedRam.
+    };
+
+    /// Rectangle on the panel in RAM pixel coordinates.
+    struct Window
+    {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+    };
+
+    /// Long running operations of the non-blocking API.
+    enum class Operation : uint8_t
+    {
+        None,    //!< No operation is running.
+        Init,    //!< Started by startInit().
+        Reset,   //!< Started by startReset().
+        LoadLut, //!< Started by startLoadLut().
+        Refresh  //!< Started by startRefresh().
+    };
+
+    using OperationCallback = void (*)(void *context);
+
+    /// Renders \p rows rows of both planes, starting at \p firstRow, into the band buffers.
+    /// Rows are counted in transfer order, as in the images passed to submitPlanes(). Each row
+    /// has width / 8 bytes. \p redBand is nullptr if only the BW plane is streamed.
+    using BandRenderer = void (*)(void *context, uint16_t firstRow, uint16_t rows,
+                                  uint8_t *bwBand, uint8_t *redBand);
+
+    /// LUTs valid within a temperature range, see setWaveformBands().
+    struct WaveformBand
+    {
+        int8_t minTemperature; //!< Lowest temperature in °C the LUTs are valid for.
+        int8_t maxTemperature; //!< Highest temperature in °C the LUTs are valid for.
+        LutSelection lut;      //!< LUT used by fullRefresh().
+        LutSelection partialLut = LutSelection::Delta; //!< LUT used by partialRefresh().
+    };
+
+    /// Counters of the LUT uploads, see lutStatistics().
+    struct LutStatistics
+    {
+        uint32_t uploads;        //!< LUTs written to the controller.
+        uint32_t skippedUploads; //!< Uploads skipped since the LUT was resident already.
+        uint32_t uploadedBytes;  //!< Bytes written to the LUT register.
+    };
+
     explicit SSD1675a(SSDInterface &interface) : interface(interface){};
 
-    /// needs to be called before init
+    /// Enables submitImageAsync() to transfer RAM data in the background.
+    explicit SSD1675a(SSDAsyncInterface &interface)
+        : interface(interface), asyncInterface(&interface){};
+
+#if defined(SSD_DISPLAY_DRIVER_INSTRUMENTATION)
+    /// Accounts the bus traffic of the driver operations to their operation types.
+    /// \param instrumentationRecorder Recorder shared with the instrumented interface, nullptr
+    ///                                to disable.
+    void setInstrumentation(instrumentation::Recorder *instrumentationRecorder)
+    {
+        recorder = instrumentationRecorder;
+    }
+#endif
+
+    /// Selects the LUT written by init() and loadLut(). It is only uploaded if it is not
+    /// resident in the controller already.
     void selectLut(LutSelection selection)
     {
         lutSelection = selection;
     }
 
+    /// \return LUT held by the LUT register of the controller, None if unknown.
+    LutSelection residentLut() const
+    {
+        return lutInController;
+    }
+
+    /// Forgets the resident LUT, e.g. after resetting the controller by its reset pin.
+    /// softwareReset() and deepSleep() do this on their own.
+    void invalidateLut()
+    {
+        lutInController = LutSelection::None;
+    }
+
+    const LutStatistics &lutStatistics() const
+    {
+        return lutCounters;
+    }
+
+    /// \return Duration of the waveform of \p selection in microseconds.
+    uint64_t lutDurationUs(LutSelection selection) const;
+
     void init();
 
+    /// Sets the table of temperature banded LUTs used by selectLutForTemperature(). Bands may
+    /// overlap; the shortest waveform valid for the temperature wins.
+    /// \param bands Table, which has to outlive the driver or the next call.
+    void setWaveformBands(const WaveformBand *bands, size_t numberOfBands)
+    {
+        waveformBands = bands;
+        numberOfWaveformBands = numberOfBands;
+    }
+
+    /// Measures the temperature with the internal sensor and loads it into the temperature
+    /// register. Blocks while the controller is busy.
+    /// \param celsius Measured temperature, rounded down to full degrees.
+    /// \return False if the interface cannot read (see SSDInterface::readData()).
+    bool readTemperature(int8_t &celsius);
+
+    /// Writes an externally measured temperature into the temperature register, e.g. from a
+    /// sensor on the board if the interface cannot read. Switches to the external sensor until
+    /// the next readTemperature().
+    void setTemperature(int8_t celsius);
+
+    /// \return Temperature last read or set, INT8_MIN if unknown.
+    int8_t temperature() const
+    {
+        return lastTemperature;
+    }
+
+    /// Selects and loads the shortest LUT of the waveform bands valid for \p celsius. The LUT
+    /// is only uploaded if it is not resident. The selection is kept if no band applies.
+    /// The band also becomes the source of the LUTs used by fullRefresh() and partialRefresh().
+    /// \return Selected LUT, None if no band applies.
+    LutSelection selectLutForTemperature(int8_t celsius);
+
+    /// Selects the LUT for the temperature set by setTemperature(), or for the one read from the
+    /// internal sensor if none has been set.
+    /// \return Selected LUT, None if the temperature is unknown or no band applies.
+    LutSelection updateWaveform();
+
+    /// Non-blocking API: starts an operation and returns immediately.
+    /// The operation is driven by poll(), which needs to be called periodically or when the busy
+    /// pin has been released. Only one operation runs at a time, a start function returns false
+    /// if another one is still running.
+    bool startInit();
+    bool startReset();
+    bool startLoadLut();
+    bool startRefresh();
+
+    /// Starts a refresh with the given LUT, which is uploaded first if it is not resident.
+    bool startRefresh(LutSelection selection);
+
+    /// Advances the running operation, if the controller is not busy anymore.
+    /// \return True if no operation is running anymore.
+    bool poll();
+
+    Operation runningOperation() const
+    {
+        return operation;
+    }
+
+    /// Sets a function which is called once by poll() when the running operation has completed.
+    void onOperationComplete(OperationCallback callback, void *context)
+    {
+        operationCallback = callback;
+        operationContext = context;
+    }
+
     void setDriverOutput(uint8_t value1, uint8_t value2, uint8_t value3);
     void setSourceDrivingVoltage(uint8_t value1, uint8_t value2, uint8_t value3);
     void deepSleep(uint8_t mode);
@@ -43,9 +205,29 @@ public:
     void masterActivation();
     void setDisplayUpdateControl1(RamOption redRamOption, RamOption blackRamOption,
                                   bool outputMode);
+    /// Sets the sequence run by masterActivation(). Kept by readTemperature(), but replaced by
+    /// the refreshes which select a LUT, see refreshSequence().
     void setDisplayUpdateControl2(uint8_t value);
+
+    /// \return Bit polarity of the BW and red RAM set by setDisplayUpdateControl1(), to be
+    /// passed to the color_planes packers.
+    color_planes::PlaneFormat planeFormat() const
+    {
+        return {blackRamOption == RamOption::Inverse, redRamOption == RamOption::Inverse};
+    }
+
     void writeVcomRegister(uint8_t value);
+
+    /// Uploads the selected LUT and blocks until the controller has processed it. Like init(),
+    /// the refreshes and the non-blocking API, it uploads by writeLut(), which is the function
+    /// to override for customizing the upload of all of them.
     virtual void loadLut();
+
+    /// Refreshes the display with the given LUT and blocks until the refresh is done.
+    /// Switching LUTs costs an upload, which is skipped if \p selection is resident already.
+    /// The selection stays active for the following refreshes.
+    void refreshWithLut(LutSelection selection);
+
     void setBorderWaveform(uint8_t value);
     void setXStartEnd(uint8_t start, uint8_t end);
     void setYStartEnd(uint16_t start, uint16_t end);
@@ -59,10 +241,301 @@ public:
 
     void draw(uint8_t data);
     void draw(const uint8_t *data, size_t length);
+
+    /// IRenderTarget entry point, kept for compatibility with the length encoding:
+    /// bit 24 selects the BW RAM, bit 26 the red RAM, the lower 16 bits are the size and a
+    /// length of 0 triggers the activation. New code should use submitPlanes().
     void submitImage(const uint8_t *image, size_t length) override;
 
+    /// Writes both RAM planes of the whole panel back-to-back and refreshes the display once.
+    /// The RAM window is set up once; only the address counter is reset between the planes.
+    /// Once the red RAM holds the previous image for partialRefresh(), a BW image without red
+    /// image is written into both RAMs and the refresh bypasses the red RAM, see fullRefresh().
+    /// \param bwImage     BW RAM data, nullptr to leave the BW RAM untouched.
+    /// \param redImage    Red RAM data, nullptr to leave the red RAM untouched.
+    /// \param planeLength Size of each plane in bytes.
+    /// \param activate    True to trigger the master activation after the upload.
+    void submitPlanes(const uint8_t *bwImage, const uint8_t *redImage, size_t planeLength,
+                      bool activate = true);
+
+    /// Writes both RAM planes of a window, see submitPlanes().
+    /// \param window Window to write, aligned by alignWindow(). The images have to cover the
+    ///               aligned window.
+    void submitPlanes(const uint8_t *bwImage, const uint8_t *redImage, const Window &window,
+                      bool activate = true);
+
+    /// Writes both planes band by band, pulling each band from \p renderer, so no whole image
+    /// has to be kept in memory. The RAM window is set up once; the address counter is moved to
+    /// the start of the band before each plane.
+    /// \param bwBand   Band buffer of \p bandRows * width / 8 bytes for the BW plane.
+    /// \param redBand  Band buffer of the same size for the red plane, nullptr to leave the red
+    ///                 RAM untouched.
+    /// \param bandRows Rows per band, e.g. 8 for two buffers of 152 bytes on a 152x296 panel.
+    /// \param activate True to trigger the master activation after the upload.
+    void submitStreamedPlanes(BandRenderer renderer, void *context, uint8_t *bwBand,
+                              uint8_t *redBand, uint16_t bandRows, bool activate = true);
+
+    /// Expands both planes compressed by image_compression::compress() band by band while
+    /// writing them, see submitStreamedPlanes(). Rows missing in the data are white.
+    /// \param bwData   Compressed BW plane of the full panel, e.g. in flash.
+    /// \param redData  Compressed red plane, nullptr to leave the red RAM untouched.
+    /// \param activate True to trigger the master activation after the upload.
+    void submitCompressedPlanes(const uint8_t *bwData, size_t bwLength, const uint8_t *redData,
+                                size_t redLength, bool activate = true);
+
+    /// Fills a whole RAM plane with \p value. 0x00 and 0xFF use the auto write RAM command, which
+    /// takes two bytes on the bus and blocks while the controller is busy writing the pattern.
+    /// Other values are streamed, see fillPlane(Plane, uint8_t, const Window &).
+    void fillPlane(Plane plane, uint8_t value);
+
+    /// Fills a window of a RAM plane with \p value by streaming it from a small constant buffer,
+    /// since the auto write patterns always cover the whole RAM.
+    /// \param window Window to fill, aligned by alignWindow().
+    void fillPlane(Plane plane, uint8_t value, const Window &window);
+
+    /// Fills the BW RAM with white and the red RAM with not red, in the polarity of
+    /// planeFormat(), e.g. to blank the panel before a partial redraw.
+    void clearPlanes();
+
+    /// Writes \p length bytes into a RAM plane at the current address counter.
+    void writePlane(Plane plane, const uint8_t *image, size_t length);
+
+    /// Starts writing the RAM data in the background, see submitImage() for the encoding of
+    /// \p length. Activation (\p length 0) is done synchronously.
+    ///
+    /// The driver owns \p image until the transfer has completed. Every following call writing
+    /// to the bus waits for it first, so the image is free again once the next
+    /// submitImageAsync() has returned. Without an SSDAsyncInterface, submitImage() is used.
+    void submitImageAsync(const uint8_t *image, size_t length);
+
+    /// \return True if no transfer started by submitImageAsync() is running.
+    bool isImageTransferComplete();
+
+    /// Blocks until the transfer started by submitImageAsync() has completed.
+    void waitForImageTransfer();
+
+    /// Expands the window horizontally to byte boundaries and clips it to the panel.
+    /// The image passed to partialRefresh() has to cover this aligned window.
+    static Window alignWindow(const Window &window);
+
+    /// Sets the number of partial refreshes a region of the panel may receive before
+    /// partialRefresh() cleans up the ghosting with a full refresh instead.
+    void setGhostingBudget(uint8_t budget)
+    {
+        ghostingBudget = budget;
+    }
+
+    /// Updates a window of the panel using the Delta waveform, or the partial LUT of the waveform
+    /// band last selected by selectLutForTemperature().
+    ///
+    /// The window is written into the BW RAM, which holds the new image, and after the refresh
+    /// into the red RAM, which holds the previous image the Delta waveform depends on. The red
+    /// RAM is read with the polarity of the BW RAM during the refresh, so the LUT of each pixel
+    /// is selected by its previous and new color.
+    /// The red RAM has to hold the image shown outside the window, which is loaded by
+    /// fullRefresh(const uint8_t *, size_t) and by the following BW only submitPlanes() calls.
+    /// Until then, and once a region exceeds the ghosting budget, fullRefresh() is used instead.
+    /// Meant for black/white content only, since the red RAM is occupied by the previous image.
+    /// \param image  Image data of the aligned window (see alignWindow()), with rows of
+    ///               width / 8 bytes in the order given by the data entry mode.
+    /// \param window Window to update, in RAM pixel coordinates.
+    void partialRefresh(const uint8_t *image, const Window &window);
+
+    /// Refreshes the whole panel from the BW RAM with the Default waveform, or the LUT of the
+    /// waveform band last selected by selectLutForTemperature(), bypassing the red RAM holding
+    /// the previous image, and resets the partial refresh counters.
+    void fullRefresh();
+
+    /// Writes \p image into the BW RAM and, as previous image for partialRefresh(), into the
+    /// red RAM, then refreshes the whole panel, see fullRefresh().
+    /// \param image       BW RAM data of the whole panel.
+    /// \param planeLength Size of the plane in bytes.
+    void fullRefresh(const uint8_t *image, size_t planeLength);
+
+    /// Starts collecting commands and their parameters instead of writing them one by one.
+    ///
+    /// Commands issued by any setter until endTransaction() are sent with a single
+    /// SSDInterface::writeCommandSequence() call. The collected commands are sent early if the
+    /// buffer is full, before RAM/LUT data is written and before waiting for the busy pin.
+    /// Plane, window and LUT uploads append their data to the transaction instead, so the
+    /// commands and the data are sent with a single SSDInterface::writeSegments() call.
+    /// Transactions can be nested, only the outermost endTransaction() sends the commands.
+    ///
+    /// The appended data is not copied: plane and window buffers passed to submitPlanes() or
+    /// partialRefresh() must stay valid and unmodified until the outermost endTransaction().
+    void beginTransaction();
+
+    /// Sends the collected commands and stops collecting.
+    void endTransaction();
+
+#if defined(__cpp_impl_coroutine)
+    /// Awaitable of an operation of the non-blocking API, resumed from poll().
+    class Awaitable
+    {
+    public:
+        Awaitable(SSD1675a &driver, bool isStarted) : driver(driver), isStarted(isStarted){};
+
+        bool await_ready() const noexcept
+        {
+            return !isStarted || driver.runningOperation() == Operation::None;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            driver.onOperationComplete(&resume, handle.address());
+        }
+
+        /// \return False if the operation could not be started, because another one was running.
+        bool await_resume() const noexcept
+        {
+            return isStarted;
+        }
+
+    private:
+        SSD1675a &driver;
+        bool isStarted;
+
+        static void resume(void *address)
+        {
+            std::coroutine_handle<>::from_address(address).resume();
+        }
+    };
+
+    /// Coroutine API on top of the non-blocking API, e.g. co_await panel.refresh().
+    Awaitable initialize()
+    {
+        return {*this, startInit()};
+    }
+
+    Awaitable reset()
+    {
+        return {*this, startReset()};
+    }
+
+    Awaitable reloadLut()
+    {
+        return {*this, startLoadLut()};
+    }
+
+    Awaitable refresh()
+    {
+        return {*this, startRefresh()};
+    }
+#endif
+
 protected:
+    static constexpr auto RegionColumns = 4;
+    static constexpr auto RegionRows = 8;
+    static constexpr size_t TransactionCapacity = 64;
+    static constexpr size_t NoRecord = TransactionCapacity;
+    static constexpr size_t SegmentCapacity = 16;
+
     SSDInterface &interface;
+    SSDAsyncInterface *asyncInterface = nullptr;
+#if defined(SSD_DISPLAY_DRIVER_INSTRUMENTATION)
+    instrumentation::Recorder *recorder = nullptr;
+#endif
+    bool isImageTransferRunning = false;
+
+    std::array<uint8_t, TransactionCapacity> transactionBuffer{};
+    size_t transactionLength = 0;
+    size_t recordStart = NoRecord; //!< Start of the record collecting parameters.
+    bool isRecordBypassed = false;  //!< Parameters of the current command are written directly.
+    uint8_t transactionDepth = 0;
+
+    /// Segments of the open transaction not sent yet, see appendData().
+    std::array<SSDInterface::Segment, SegmentCapacity> segments{};
+    size_t numberOfSegments = 0;
+
+    /// Length of the part of the transaction buffer referenced by segments.
+    size_t segmentedLength = 0;
+
+    Operation operation = Operation::None;
+    uint8_t operationStep = 0;
+    OperationCallback operationCallback = nullptr;
+    void *operationContext = nullptr;
+
+    /// Writes the selected LUT to the controller without waiting for it to be processed.
+    /// Every LUT upload of the driver goes through it; the tables themselves are provided by
+    /// lutData() and lutLayout().
+    /// \return False if no LUT is selected or if it is resident already.
+    virtual bool writeLut();
+
+    /// \return Data of the LUT of \p selection, of lutLayout().size bytes.
+    virtual const uint8_t *lutData(LutSelection selection) const;
+    virtual const lut_timing::Layout &lutLayout() const;
+
+    /// Does the next step of the running operation.
+    /// \return True if the operation has completed.
+    bool advanceOperation();
+    void completeOperation();
 
     LutSelection lutSelection = LutSelection::None;
+    LutSelection lutInController = LutSelection::None;
+    LutStatistics lutCounters{};
+
+    const WaveformBand *waveformBands = nullptr;
+    size_t numberOfWaveformBands = 0;
+    LutSelection fullRefreshLut = LutSelection::Default;
+    LutSelection partialRefreshLut = LutSelection::Delta;
+    int8_t lastTemperature = INT8_MIN;
+    bool isTemperatureExternal = false;
+
+    uint8_t dataEntryMode = 0b011;
+    uint8_t displayUpdateControl2 = 0xFF; //!< Reset value, loads the LUT from the OTP.
+    RamOption redRamOption = RamOption::Normal;
+    RamOption blackRamOption = RamOption::Normal;
+    bool outputMode = false;
+
+    uint8_t ghostingBudget = 8;
+    std::array<uint8_t, RegionColumns * RegionRows> regionRefreshCounts{};
+
+    bool isRedRamPreviousImage = false; //!< The red RAM is used by partialRefresh().
+    bool isPreviousImageLoaded = false; //!< The red RAM holds the image shown by the panel.
+
+    /// Keeps track of the RAM contents used by partialRefresh() when writing a plane.
+    void trackPlaneWrite(Plane plane);
+
+    void writeDisplayUpdateControl1(RamOption redOption, RamOption blackOption, bool output);
+
+    /// Sets the display update sequence of a refresh with the selected LUT: the uploaded one, or
+    /// the one in OTP if none is selected.
+    void setRefreshSequence();
+
+    /// Sets RAM window and address counter according to the data entry mode.
+    void setRamWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd);
+
+    /// Sets the address counter to the first position of the window according to the data
+    /// entry mode.
+    void resetAddressCounter(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd);
+    void writeWindow(uint8_t ramCommand, const uint8_t *image, const Window &window);
+
+    /// Like writePlane(), but the image is appended to the transaction, see appendData().
+    void appendPlane(Plane plane, const uint8_t *image, size_t length);
+
+    /// Increases the refresh counters of all regions covered by the window.
+    /// \return True if any region exceeded the ghosting budget.
+    bool countPartialRefresh(const Window &window);
+
+    /// Write directly or append to the open transaction.
+    void writeCommand(uint8_t cmd);
+    void writeData(uint8_t data);
+    void writeData(const uint8_t *data, size_t length);
+
+    /// Like writeData(), but inside a transaction the data is not copied. It is sent after the
+    /// records collected so far as SSDInterface::Segment, so it has to stay valid until the
+    /// transaction is flushed.
+    void appendData(const uint8_t *data, size_t length);
+
+    /// Adds a segment, sending the collected ones first if the list is full.
+    void appendSegment(SSDInterface::Segment::Type type, const uint8_t *data, size_t length);
+
+    /// Adds the records of the transaction buffer up to \p end as segments.
+    void appendRecordSegments(size_t end);
+
+    /// Sends the records of the transaction buffer up to \p end, together with the collected
+    /// segments if there are any.
+    void sendRecords(size_t end);
+    void waitUntilIdle();
+    void flushTransaction();
 };
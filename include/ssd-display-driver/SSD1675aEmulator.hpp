@@ -0,0 +1,207 @@
+#pragma once
+
+#include "LutTiming.hpp"
+#include "SSDInterface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Host-side emulation of a SSD1675a/SSD1680 ePaper controller for testing drivers without a
+/// panel.
+///
+/// Decodes the command stream into BW and red RAM and models the busy pin on a virtual clock.
+/// The busy time of a refresh is computed from the uploaded waveform, so waitUntilIdle()
+/// advances the clock by a realistic refresh time. Waveform semantics (e.g. Delta) are not
+/// modelled, the panel shows the RAM contents after applying the display update control 1
+/// options.
+/// Host only, it is built into the ssd-display-driver-emulators library.
+class SSD1675aEmulator : public SSDInterface
+{
+public:
+    enum class Variant
+    {
+        SSD1675a, //!< 70 byte LUT.
+        SSD1680   //!< 153 byte LUT with frame rate bytes.
+    };
+
+    enum class Color : uint8_t
+    {
+        White,
+        Black,
+        Red
+    };
+
+    struct Statistics
+    {
+        size_t commandBytes = 0;
+        size_t dataBytes = 0;
+        size_t transactions = 0;
+        size_t refreshes = 0;
+        size_t lutUploads = 0;
+        size_t autoWrites = 0;        //!< RAM fills by the auto write RAM commands.
+        uint64_t busyTimeNs = 0;      //!< Time the busy pin was high.
+        uint64_t lastRefreshNs = 0;   //!< Busy time of the last refresh.
+    };
+
+    /// \param variant Controller to be emulated.
+    /// \param width   Panel width in pixels, multiple of 8.
+    /// \param height  Panel height in pixels.
+    explicit SSD1675aEmulator(Variant variant = Variant::SSD1675a, uint16_t width = 152,
+                              uint16_t height = 296);
+
+    void writeCommand(uint8_t cmd) override;
+    void writeCommandSequence(const uint8_t *sequence, size_t length) override;
+    void writeData(uint8_t data) override;
+    void writeData(const uint8_t *data, size_t length) override;
+
+    /// Reads the temperature register after ReadTemperatureSensor, fails for other commands.
+    bool readData(uint8_t *data, size_t length) override;
+
+    /// Advances the virtual clock to the end of the busy period.
+    void waitUntilIdle() override;
+    bool isBusy() override;
+
+    /// Sets the SPI clock used to advance the virtual clock for bus transfers.
+    void setBusClock(uint32_t clockHz)
+    {
+        busClockHz = clockHz;
+    }
+
+    /// Busy time of a refresh using the waveform in OTP, i.e. without an uploaded LUT.
+    void setOtpRefreshTime(uint64_t timeNs)
+    {
+        otpRefreshNs = timeNs;
+    }
+
+    /// Frame rate in mHz for SSD1675a waveforms, which do not contain frame rate bytes.
+    void setFrameRate(uint32_t milliHz)
+    {
+        frameRate = milliHz;
+    }
+
+    /// Advances the virtual clock, e.g. while polling with the non-blocking driver API.
+    void advanceTime(uint64_t timeNs)
+    {
+        nowNs += timeNs;
+    }
+
+    uint64_t now() const
+    {
+        return nowNs;
+    }
+
+    /// Temperature measured by the internal sensor, in °C.
+    void setSensorTemperature(int8_t celsius)
+    {
+        sensorTemperature = celsius;
+    }
+
+    /// Temperature register used for the waveform, in 1/16 °C.
+    int16_t temperatureRegister() const
+    {
+        return temperatureValue;
+    }
+
+    const Statistics &statistics() const
+    {
+        return stats;
+    }
+
+    void clearStatistics()
+    {
+        stats = Statistics{};
+    }
+
+    /// RAM contents at the given byte column (x / 8) and row.
+    uint8_t bwRam(uint16_t xByte, uint16_t y) const;
+    uint8_t redRam(uint16_t xByte, uint16_t y) const;
+
+    /// Color of the pixel shown after the last refresh.
+    Color displayPixel(uint16_t x, uint16_t y) const;
+
+    /// LUT (0 to 3) the last refresh selected for the pixel, formed by its red RAM bit (bit 1)
+    /// and its BW RAM bit (bit 0) after applying the display update control 1 options.
+    uint8_t lutIndex(uint16_t x, uint16_t y) const;
+
+    /// \return True if the LUT of the pixel in the last refresh applies any voltage other than
+    ///         VSS, always true for the waveform in OTP.
+    bool isPixelDriven(uint16_t x, uint16_t y) const;
+
+    /// Duration of the uploaded waveform, 0 if none has been uploaded.
+    uint64_t lutDurationNs() const;
+
+    const std::vector<uint8_t> &lut() const
+    {
+        return lutRegister;
+    }
+
+    uint8_t dataEntryMode() const
+    {
+        return entryMode;
+    }
+
+    /// Sequence of display update control 2, run by the master activation.
+    uint8_t displayUpdateSequence() const
+    {
+        return updateControl2;
+    }
+
+protected:
+    static constexpr uint64_t ResetTimeNs = 2'000'000;
+    static constexpr uint64_t AutoWriteTimeNs = 1'000'000;
+    static constexpr uint64_t TemperatureLoadTimeNs = 5'000'000;
+
+    Variant variant;
+    lut_timing::Layout layout;
+    uint16_t width;
+    uint16_t height;
+    uint16_t bytesPerRow;
+
+    std::vector<uint8_t> bwPlane;
+    std::vector<uint8_t> redPlane;
+    std::vector<uint8_t> panelBw;
+    std::vector<uint8_t> panelRed;
+    bool isRedShown = true;
+
+    std::vector<uint8_t> lutRegister;
+
+    uint8_t entryMode = 0b011;
+    uint8_t updateControl1 = 0;
+    uint8_t updateControl2 = 0xFF;
+    uint8_t xStart = 0;
+    uint8_t xEnd = 0;
+    uint16_t yStart = 0;
+    uint16_t yEnd = 0;
+    uint8_t xCounter = 0;
+    uint16_t yCounter = 0;
+
+    uint8_t temperatureSensor = 0x80;
+    int16_t temperatureValue = 0;
+    int8_t sensorTemperature = 25;
+
+    uint8_t currentCommand = 0;
+    size_t parameterIndex = 0;
+    uint16_t parameterWord = 0;
+
+    uint32_t busClockHz = 4'000'000;
+    uint32_t frameRate = lut_timing::DefaultFrameRateMilliHz;
+    uint64_t otpRefreshNs = 15'000'000'000;
+    uint64_t nowNs = 0;
+    uint64_t busyUntilNs = 0;
+
+    Statistics stats;
+
+    void resetRegisters();
+    void startCommand(uint8_t cmd);
+    void applyParameter(uint8_t value);
+    void writeRam(std::vector<uint8_t> &plane, uint8_t value);
+
+    /// Fills the plane with the regular pattern of an auto write RAM command. Steps are
+    /// at least 8 pixels wide, so whole bytes are written.
+    void autoWrite(std::vector<uint8_t> &plane, uint8_t parameter);
+    void advanceCounter();
+    void activate();
+    void setBusy(uint64_t timeNs);
+    void recordTransaction(size_t commandBytes, size_t dataBytes);
+};
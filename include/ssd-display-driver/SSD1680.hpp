@@ -12,6 +12,9 @@ private:
 
 public:
     explicit SSD1680(SSDInterface &interface) : SSD1675a(interface){};
+    explicit SSD1680(SSDAsyncInterface &interface) : SSD1675a(interface){};
 
-    void loadLut() override;
+protected:
+    const uint8_t *lutData(LutSelection selection) const override;
+    const lut_timing::Layout &lutLayout() const override;
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "SSDInterface.hpp"
+
+/// Hardware interface to a display controller, which is able to write pixel data in the
+/// background, e.g. using DMA.
+class SSDAsyncInterface : public SSDInterface
+{
+public:
+    using CompletionCallback = void (*)(void *context);
+
+    /// Starts writing multiple bytes to the display driver's RAM and returns immediately.
+    /// The data must stay valid and unmodified until the transfer has completed.
+    /// Only one transfer is started at a time, no other method is called while it is running.
+    /// \param data   Pointer to the pixel data to be written.
+    /// \param length The number of data bytes to be written.
+    virtual void startWriteData(const uint8_t *data, size_t length) = 0;
+
+    /// \return True if the transfer started by startWriteData() has completed.
+    virtual bool isTransferComplete() = 0;
+
+    /// Blocks until the transfer started by startWriteData() has completed.
+    /// Its clever to wait for a FreeRTOS notification instead of polling, if a RTOS is used.
+    virtual void waitForTransfer()
+    {
+        while (!isTransferComplete())
+        {
+        }
+    }
+
+    /// Sets the function to be called when a transfer has completed.
+    /// Depending on the implementation, it is called from interrupt context.
+    void setCompletionCallback(CompletionCallback callback, void *context)
+    {
+        completionCallback = callback;
+        completionContext = context;
+    }
+
+protected:
+    /// Needs to be called by the implementation when a transfer has completed,
+    /// e.g. from the DMA transfer complete interrupt.
+    void notifyTransferComplete()
+    {
+        if (completionCallback != nullptr)
+            completionCallback(completionContext);
+    }
+
+private:
+    CompletionCallback completionCallback = nullptr;
+    void *completionContext = nullptr;
+};
+
+/// Adapts a blocking SSDInterface to SSDAsyncInterface.
+/// Transfers are done synchronously inside startWriteData() and complete immediately.
+class BlockingAsyncAdapter : public SSDAsyncInterface
+{
+public:
+    explicit BlockingAsyncAdapter(SSDInterface &interface) : interface(interface){};
+
+    void writeCommand(uint8_t cmd) override
+    {
+        interface.writeCommand(cmd);
+    }
+
+    void writeCommands(const uint8_t *cmds, size_t length) override
+    {
+        interface.writeCommands(cmds, length);
+    }
+
+    void writeCommandSequence(const uint8_t *sequence, size_t length) override
+    {
+        interface.writeCommandSequence(sequence, length);
+    }
+
+    void writeData(uint8_t data) override
+    {
+        interface.writeData(data);
+    }
+
+    void writeData(const uint8_t *data, size_t length) override
+    {
+        interface.writeData(data, length);
+    }
+
+    void writeSegments(const Segment *segments, size_t numberOfSegments) override
+    {
+        interface.writeSegments(segments, numberOfSegments);
+    }
+
+    bool readData(uint8_t *data, size_t length) override
+    {
+        return interface.readData(data, length);
+    }
+
+    void waitUntilIdle() override
+    {
+        interface.waitUntilIdle();
+    }
+
+    bool isBusy() override
+    {
+        return interface.isBusy();
+    }
+
+    void startWriteData(const uint8_t *data, size_t length) override
+    {
+        interface.writeData(data, length);
+        notifyTransferComplete();
+    }
+
+    bool isTransferComplete() override
+    {
+        return true;
+    }
+
+private:
+    SSDInterface &interface;
+};
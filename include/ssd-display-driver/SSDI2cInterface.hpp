@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SSDInterface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/// Reference SSDInterface for SSD1305/SSD1306 displays connected by I2C.
+///
+/// On I2C, every transaction starts with the slave address and a control byte selecting
+/// commands or data. Instead of one transaction per byte, all bytes of a call are packed into
+/// as few transactions as possible: command bytes behind a single control byte 0x00 (Co = 0,
+/// D/C# = 0) and data bytes behind a single 0x40 (Co = 0, D/C# = 1). Consecutive segments of the
+/// same type in writeSegments() share one transaction. Transactions exceeding the maximum
+/// transfer size of the bus are split, each part starting with the control byte again.
+///
+/// The driver sends a command together with its parameters, and its transactions (see
+/// SSD1305::beginTransaction()) with a single call, so they end up in one I2C transaction.
+class SSDI2cInterface : public SSDInterface
+{
+public:
+    /// I2C master of the platform.
+    class Bus
+    {
+    public:
+        /// Writes \p length bytes to the slave as one transaction, i.e. start condition, slave
+        /// address, the bytes and stop condition.
+        /// \param address 7 bit slave address.
+        virtual void write(uint8_t address, const uint8_t *data, size_t length) = 0;
+    };
+
+    /// \param address         7 bit slave address, 0x3C or 0x3D depending on the SA0 pin.
+    /// \param transferBuffer  Buffer collecting a transaction.
+    /// \param maxTransferSize Size of \p transferBuffer, the maximum number of bytes per
+    ///                        transaction including the control byte, e.g. 32 for the buffer
+    ///                        of the Arduino Wire library.
+    /// \pre \p maxTransferSize is at least 2, so a transaction holds a byte behind the control
+    ///      byte. Asserted by the writes, which send nothing otherwise.
+    SSDI2cInterface(Bus &bus, uint8_t address, uint8_t *transferBuffer, size_t maxTransferSize)
+        : bus(bus), address(address), transferBuffer(transferBuffer),
+          maxTransferSize(maxTransferSize){};
+
+    void writeCommand(uint8_t cmd) override;
+    void writeCommands(const uint8_t *cmds, size_t length) override;
+    void writeData(uint8_t data) override;
+    void writeData(const uint8_t *data, size_t length) override;
+    void writeSegments(const Segment *segments, size_t numberOfSegments) override;
+
+    /// OLED controllers have no busy pin.
+    void waitUntilIdle() override{};
+
+private:
+    Bus &bus;
+    uint8_t address;
+    uint8_t *transferBuffer;
+    size_t maxTransferSize;
+
+    /// Bytes collected in the transfer buffer, including the control byte.
+    size_t transferLength = 0;
+
+    /// Appends bytes to the current transaction, starting a new one if the control byte differs
+    /// or the transfer buffer is full.
+    void append(uint8_t control, const uint8_t *bytes, size_t length);
+
+    /// Writes the collected transaction to the bus.
+    void flush();
+};
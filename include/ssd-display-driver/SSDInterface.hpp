@@ -7,10 +7,56 @@
 class SSDInterface
 {
 public:
+    /// Part of a scatter-gather write, see writeSegments().
+    struct Segment
+    {
+        enum class Type : uint8_t
+        {
+            Command, //!< Command bytes, like writeCommands().
+            Data     //!< Data bytes, including command parameters, like writeData().
+        };
+
+        Type type;
+        const uint8_t *data;
+        size_t length;
+    };
+
     /// Writes a single command byte to the display driver.
     /// \param cmd The command byte to be written.
     virtual void writeCommand(uint8_t cmd) = 0;
 
+    /// Writes multiple command bytes to the display driver in one transfer.
+    /// The default implementation writes them one by one using writeCommand(uint8_t).
+    /// \param cmds   Pointer to the command bytes to be written.
+    /// \param length The number of command bytes to be written.
+    virtual void writeCommands(const uint8_t *cmds, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+            writeCommand(cmds[i]);
+    }
+
+    /// Writes a sequence of commands with their parameter bytes in one transfer.
+    /// The sequence consists of records, each encoded as the command byte, the number of
+    /// parameter bytes and the parameter bytes itself. Parameters are sent as data, as
+    /// required by SSD1675a/SSD1680. The default implementation decodes the records into
+    /// writeCommand(uint8_t) and writeData(uint8_t) calls.
+    /// \param sequence Pointer to the encoded records.
+    /// \param length   Length of the encoded records in bytes.
+    virtual void writeCommandSequence(const uint8_t *sequence, size_t length)
+    {
+        size_t i = 0;
+
+        while (i + 1 < length)
+        {
+            writeCommand(sequence[i]);
+            size_t numberOfParameters = sequence[i + 1];
+            i += 2;
+
+            for (; numberOfParameters > 0 && i < length; --numberOfParameters, ++i)
+                writeData(sequence[i]);
+        }
+    }
+
     /// Writes a single data byte to the display driver's GDDRAM.
     /// This method writes a single byte to the frame buffer in the display
     /// driver's GDDRAM. The write position is then updated according to the
@@ -26,8 +72,52 @@ public:
     /// \param length The number of data bytes to be written.
     virtual void writeData(const uint8_t *data, size_t length) = 0;
 
+    /// Writes a list of command and data segments in order, e.g. as one chained DMA transfer or
+    /// one SPI_IOC_MESSAGE batch, avoiding the setup time between the segments. The segments
+    /// are only valid during the call. The default implementation writes each segment with
+    /// writeCommands() or writeData(const uint8_t *, size_t).
+    /// \param segments         Pointer to the segments to be written.
+    /// \param numberOfSegments The number of segments.
+    virtual void writeSegments(const Segment *segments, size_t numberOfSegments)
+    {
+        for (size_t i = 0; i < numberOfSegments; ++i)
+        {
+            const Segment &segment = segments[i];
+
+            if (segment.length == 0)
+                continue;
+
+            if (segment.type == Segment::Type::Command)
+                writeCommands(segment.data, segment.length);
+            else
+                writeData(segment.data, segment.length);
+        }
+    }
+
+    /// Reads data bytes from the display driver, e.g. the GDDRAM over a parallel interface.
+    /// The first byte read after moving the address pointer is a dummy byte.
+    /// The default implementation has no read path, most serial interfaces cannot read.
+    /// \param data   Buffer for the bytes read.
+    /// \param length The number of bytes to be read.
+    /// \return False if reading is not supported, \p data is left unchanged then.
+    virtual bool readData(uint8_t *data, size_t length)
+    {
+        (void)data;
+        (void)length;
+        return false;
+    }
+
     /// Only needed for SSD1375a/SSD1680, which has a busy pin.
     /// For other devices simply stubs this function.
     /// Its clever to use FreeRTOS delay, if a RTOS is used.
     virtual void waitUntilIdle() = 0;
+
+    /// Only needed for SSD1375a/SSD1680, which has a busy pin.
+    /// Returns the state of the busy pin without blocking, used by the non-blocking API.
+    /// The default implementation blocks in waitUntilIdle() and reports idle afterwards.
+    virtual bool isBusy()
+    {
+        waitUntilIdle();
+        return false;
+    }
 };
\ No newline at end of file
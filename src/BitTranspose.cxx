@@ -0,0 +1,323 @@
+#include "ssd-display-driver/BitTranspose.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// SSD_DISPLAY_DRIVER_PORTABLE_TRANSPOSE forces the SWAR implementation, e.g. to test it on a
+// host with SIMD extensions
+#if !defined(SSD_DISPLAY_DRIVER_PORTABLE_TRANSPOSE)
+#if defined(__AVX2__)
+#define BIT_TRANSPOSE_AVX2
+#endif
+#if defined(__SSE2__)
+#define BIT_TRANSPOSE_SSE2
+#endif
+#if defined(__ARM_NEON)
+#define BIT_TRANSPOSE_NEON
+#endif
+#endif
+
+#if defined(BIT_TRANSPOSE_AVX2) || defined(BIT_TRANSPOSE_SSE2)
+#include <immintrin.h>
+#elif defined(BIT_TRANSPOSE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace bit_transpose
+{
+namespace
+{
+/// Source of the rows below the bottom of the image.
+constexpr uint8_t ZeroRow[MaxWidth / 8] = {};
+
+bool isMirrored(Mirror mirror, Mirror direction)
+{
+    return static_cast<uint8_t>(mirror) & static_cast<uint8_t>(direction);
+}
+
+/// Transposes the 8x8 bit matrix formed by byte \p byteIndex of the eight rows, writing the
+/// eight column bytes to \p destination.
+void transposeSwar(const uint8_t *const rows[8], size_t byteIndex, uint8_t *destination)
+{
+    // row k in byte k, so the transpose puts row k into bit k of each column byte
+    uint64_t x = 0;
+    for (size_t k = 0; k < 8; ++k)
+        x |= uint64_t{rows[k][byteIndex]} << (8 * k);
+
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+
+    for (size_t column = 0; column < 8; ++column)
+        destination[column] = static_cast<uint8_t>(x >> (56 - 8 * column));
+}
+
+// The vectorized transposes convert blocks of source bytes of all eight rows and return the
+// number of bytes converted, the rest is left to transposeSwar().
+
+#if defined(BIT_TRANSPOSE_AVX2)
+//--------------------------------------------------------------------------------------------------
+size_t transposeAvx2(const uint8_t *const rows[8], size_t numberOfBytes, uint8_t *destination)
+{
+    size_t b = 0;
+
+    for (; b + 32 <= numberOfBytes; b += 32)
+    {
+        __m256i r[8];
+        for (size_t k = 0; k < 8; ++k)
+            r[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[k] + b));
+
+        __m256i pairs[8];
+        for (size_t k = 0; k < 4; ++k)
+        {
+            pairs[2 * k] = _mm256_unpacklo_epi8(r[2 * k], r[2 * k + 1]);
+            pairs[2 * k + 1] = _mm256_unpackhi_epi8(r[2 * k], r[2 * k + 1]);
+        }
+
+        __m256i quads0123[4];
+        __m256i quads4567[4];
+        for (size_t h = 0; h < 2; ++h)
+        {
+            quads0123[2 * h] = _mm256_unpacklo_epi16(pairs[h], pairs[2 + h]);
+            quads0123[2 * h + 1] = _mm256_unpackhi_epi16(pairs[h], pairs[2 + h]);
+            quads4567[2 * h] = _mm256_unpacklo_epi16(pairs[4 + h], pairs[6 + h]);
+            quads4567[2 * h + 1] = _mm256_unpackhi_epi16(pairs[4 + h], pairs[6 + h]);
+        }
+
+        for (size_t g = 0; g < 4; ++g)
+        {
+            const __m256i octets[2] = {_mm256_unpacklo_epi32(quads0123[g], quads4567[g]),
+                                       _mm256_unpackhi_epi32(quads0123[g], quads4567[g])};
+
+            for (size_t h = 0; h < 2; ++h)
+            {
+                // lanes hold source bytes x, x + 1 and x + 16, x + 17
+                const size_t x = b + 4 * g + 2 * h;
+                uint8_t *out = destination + 8 * x;
+                __m256i v = octets[h];
+
+                for (size_t column = 0; column < 8; ++column)
+                {
+                    const uint32_t mask = _mm256_movemask_epi8(v);
+                    out[column] = mask;
+                    out[8 + column] = mask >> 8;
+                    out[128 + column] = mask >> 16;
+                    out[136 + column] = mask >> 24;
+                    v = _mm256_add_epi8(v, v);
+                }
+            }
+        }
+    }
+
+    return b;
+}
+#endif
+
+#if defined(BIT_TRANSPOSE_SSE2)
+//--------------------------------------------------------------------------------------------------
+size_t transposeSse2(const uint8_t *const rows[8], size_t b, size_t numberOfBytes,
+                     uint8_t *destination)
+{
+    for (; b + 16 <= numberOfBytes; b += 16)
+    {
+        __m128i r[8];
+        for (size_t k = 0; k < 8; ++k)
+            r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + b));
+
+        __m128i pairs[8];
+        for (size_t k = 0; k < 4; ++k)
+        {
+            pairs[2 * k] = _mm_unpacklo_epi8(r[2 * k], r[2 * k + 1]);
+            pairs[2 * k + 1] = _mm_unpackhi_epi8(r[2 * k], r[2 * k + 1]);
+        }
+
+        __m128i quads0123[4];
+        __m128i quads4567[4];
+        for (size_t h = 0; h < 2; ++h)
+        {
+            quads0123[2 * h] = _mm_unpacklo_epi16(pairs[h], pairs[2 + h]);
+            quads0123[2 * h + 1] = _mm_unpackhi_epi16(pairs[h], pairs[2 + h]);
+            quads4567[2 * h] = _mm_unpacklo_epi16(pairs[4 + h], pairs[6 + h]);
+            quads4567[2 * h + 1] = _mm_unpackhi_epi16(pairs[4 + h], pairs[6 + h]);
+        }
+
+        for (size_t g = 0; g < 4; ++g)
+        {
+            const __m128i octets[2] = {_mm_unpacklo_epi32(quads0123[g], quads4567[g]),
+                                       _mm_unpackhi_epi32(quads0123[g], quads4567[g])};
+
+            for (size_t h = 0; h < 2; ++h)
+            {
+                // lanes hold all rows of source bytes x and x + 1, the MSB is the next column
+                uint8_t *out = destination + 8 * (b + 4 * g + 2 * h);
+                __m128i v = octets[h];
+
+                for (size_t column = 0; column < 8; ++column)
+                {
+                    const uint32_t mask = _mm_movemask_epi8(v);
+                    out[column] = mask;
+                    out[8 + column] = mask >> 8;
+                    v = _mm_add_epi8(v, v);
+                }
+            }
+        }
+    }
+
+    return b;
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t transposeVectorized(const uint8_t *const rows[8], size_t numberOfBytes,
+                           uint8_t *destination)
+{
+#if defined(BIT_TRANSPOSE_AVX2)
+    // the remaining 16 byte block of e.g. 128 pixel wide images is left to SSE2
+    const size_t b = transposeAvx2(rows, numberOfBytes, destination);
+#else
+    const size_t b = 0;
+#endif
+
+    return transposeSse2(rows, b, numberOfBytes, destination);
+}
+
+#elif defined(BIT_TRANSPOSE_NEON)
+//--------------------------------------------------------------------------------------------------
+size_t transposeVectorized(const uint8_t *const rows[8], size_t numberOfBytes,
+                           uint8_t *destination)
+{
+    size_t b = 0;
+
+    for (; b + 16 <= numberOfBytes; b += 16)
+    {
+        uint8x16_t r[8];
+        for (size_t k = 0; k < 8; ++k)
+            r[k] = vld1q_u8(rows[k] + b);
+
+        uint8_t columns[8][16];
+
+        for (size_t column = 0; column < 8; ++column)
+        {
+            // bit (7 - column) of row k becomes bit k of the column byte
+            uint8x16_t accumulator = vdupq_n_u8(0);
+
+            for (size_t k = 0; k < 8; ++k)
+            {
+                const int8x16_t shift = vdupq_n_s8(static_cast<int8_t>(k + column) - 7);
+                const uint8x16_t bit = vandq_u8(vshlq_u8(r[k], shift), vdupq_n_u8(1 << k));
+                accumulator = vorrq_u8(accumulator, bit);
+            }
+
+            vst1q_u8(columns[column], accumulator);
+        }
+
+        for (size_t x = 0; x < 16; ++x)
+            for (size_t column = 0; column < 8; ++column)
+                destination[8 * (b + x) + column] = columns[column][x];
+    }
+
+    return b;
+}
+
+#else
+//--------------------------------------------------------------------------------------------------
+size_t transposeVectorized(const uint8_t *const[8], size_t, uint8_t *)
+{
+    return 0;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+void convertPageReference(const uint8_t *image, size_t width, size_t height, size_t page,
+                          uint8_t *destination, Mirror mirror)
+{
+    const size_t bytesPerRow = (width + 7) / 8;
+
+    for (size_t x = 0; x < width; ++x)
+    {
+        const size_t sourceX = isMirrored(mirror, Mirror::Horizontal) ? width - 1 - x : x;
+        uint8_t columnByte = 0;
+
+        for (size_t k = 0; k < 8; ++k)
+        {
+            const size_t y = page * 8 + k;
+
+            if (y >= height)
+                break;
+
+            const size_t sourceY = isMirrored(mirror, Mirror::Vertical) ? height - 1 - y : y;
+            const uint8_t sourceByte = image[sourceY * bytesPerRow + sourceX / 8];
+
+            if (sourceByte & (0x80 >> (sourceX % 8)))
+                columnByte |= 1 << k;
+        }
+
+        destination[x] = columnByte;
+    }
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+void convertPage(const uint8_t *image, size_t width, size_t height, size_t page,
+                 uint8_t *destination, Mirror mirror)
+{
+    if (width > MaxWidth)
+    {
+        convertPageReference(image, width, height, page, destination, mirror);
+        return;
+    }
+
+    const size_t bytesPerRow = (width + 7) / 8;
+    const size_t fullBytes = width / 8;
+
+    const uint8_t *rows[8];
+    for (size_t k = 0; k < 8; ++k)
+    {
+        const size_t y = page * 8 + k;
+
+        if (y >= height)
+            rows[k] = ZeroRow;
+        else if (isMirrored(mirror, Mirror::Vertical))
+            rows[k] = image + (height - 1 - y) * bytesPerRow;
+        else
+            rows[k] = image + y * bytesPerRow;
+    }
+
+    size_t b = transposeVectorized(rows, fullBytes, destination);
+
+    for (; b < fullBytes; ++b)
+        transposeSwar(rows, b, destination + 8 * b);
+
+    if (fullBytes != bytesPerRow)
+    {
+        uint8_t tail[8];
+        transposeSwar(rows, fullBytes, tail);
+        std::memcpy(destination + 8 * fullBytes, tail, width % 8);
+    }
+
+    if (isMirrored(mirror, Mirror::Horizontal))
+        std::reverse(destination, destination + width);
+}
+
+//--------------------------------------------------------------------------------------------------
+void rowMajorToPageMajor(const uint8_t *image, size_t width, size_t height, uint8_t *destination,
+                         Mirror mirror)
+{
+    const size_t numberOfPages = (height + 7) / 8;
+
+    for (size_t page = 0; page < numberOfPages; ++page)
+        convertPage(image, width, height, page, destination + page * width, mirror);
+}
+
+//--------------------------------------------------------------------------------------------------
+void rowMajorToPageMajorReference(const uint8_t *image, size_t width, size_t height,
+                                  uint8_t *destination, Mirror mirror)
+{
+    const size_t numberOfPages = (height + 7) / 8;
+
+    for (size_t page = 0; page < numberOfPages; ++page)
+        convertPageReference(image, width, height, page, destination + page * width, mirror);
+}
+} // namespace bit_transpose
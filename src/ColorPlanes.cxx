@@ -0,0 +1,262 @@
+#include "ssd-display-driver/ColorPlanes.hpp"
+
+#include <array>
+#include <cstring>
+
+// SSD_DISPLAY_DRIVER_PORTABLE_COLOR_PLANES forces the SWAR implementation, e.g. to test it on a
+// host with SIMD extensions
+#if !defined(SSD_DISPLAY_DRIVER_PORTABLE_COLOR_PLANES)
+#if defined(__AVX2__)
+#define COLOR_PLANES_AVX2
+#endif
+#if defined(__SSE2__)
+#define COLOR_PLANES_SSE2
+#endif
+#endif
+
+#if defined(COLOR_PLANES_AVX2) || defined(COLOR_PLANES_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace color_planes
+{
+namespace
+{
+constexpr std::array<uint8_t, 256> makeBitReverseTable()
+{
+    std::array<uint8_t, 256> table{};
+
+    for (size_t value = 0; value < table.size(); ++value)
+        for (size_t bit = 0; bit < 8; ++bit)
+            if (value & (1 << bit))
+                table[value] |= 0x80 >> bit;
+
+    return table;
+}
+
+/// Mirrors the bits of a byte, SSE2 movemask puts the leftmost pixel into the LSB.
+constexpr auto BitReverse = makeBitReverseTable();
+
+/// BW nibble in the upper and red nibble in the lower half for four 2bpp pixels,
+/// in native polarity.
+constexpr std::array<uint8_t, 256> make2bppTable()
+{
+    std::array<uint8_t, 256> table{};
+
+    for (size_t value = 0; value < table.size(); ++value)
+    {
+        uint8_t bw = 0;
+        uint8_t red = 0;
+
+        for (size_t pixel = 0; pixel < 4; ++pixel)
+        {
+            const uint8_t index = (value >> (6 - 2 * pixel)) & 0b11;
+
+            if (index != Black)
+                bw |= 0b1000 >> pixel;
+
+            if (index == Red)
+                red |= 0b1000 >> pixel;
+        }
+
+        table[value] = (bw << 4) | red;
+    }
+
+    return table;
+}
+
+constexpr auto Pack2bpp = make2bppTable();
+
+/// Maps bytes equal to \p index to 0x80 and all other bytes to 0.
+uint64_t matchBytes(uint64_t pixels, uint8_t index)
+{
+    constexpr uint64_t Low7Bits = 0x7F7F7F7F7F7F7F7FULL;
+
+    const uint64_t difference = pixels ^ (0x0101010101010101ULL * index);
+    const uint64_t nonZero = ((difference & Low7Bits) + Low7Bits) | difference;
+
+    return ~nonZero & 0x8080808080808080ULL;
+}
+
+/// Gathers the MSBs of eight bytes, the first byte becoming the MSB of the result.
+uint8_t gatherBits(uint64_t matches)
+{
+    return static_cast<uint8_t>(((matches >> 7) * 0x8040201008040201ULL) >> 56);
+}
+
+/// Packs eight pixels into one byte of each plane, in native polarity.
+void packSwar(const uint8_t *pixels, uint8_t &bw, uint8_t &red)
+{
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; ++i)
+        word |= uint64_t{pixels[i]} << (8 * i);
+
+    bw = ~gatherBits(matchBytes(word, Black));
+    red = gatherBits(matchBytes(word, Red));
+}
+
+// The vectorized packers convert blocks of pixels of one row and return the number of pixels
+// converted, the rest is left to packSwar().
+
+#if defined(COLOR_PLANES_AVX2)
+//--------------------------------------------------------------------------------------------------
+size_t packAvx2(const uint8_t *pixels, size_t width, uint8_t *bw, uint8_t *red, uint8_t bwXor,
+                uint8_t redXor)
+{
+    const __m256i black = _mm256_set1_epi8(Black);
+    const __m256i redIndex = _mm256_set1_epi8(Red);
+
+    // reverses the pixels of each byte to be packed, so movemask yields MSB-first bytes
+    const __m256i reversePixels =
+        _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+                         1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+    const uint32_t bwXorWord = 0x01010101U * bwXor;
+    const uint32_t redXorWord = 0x01010101U * redXor;
+
+    size_t x = 0;
+
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + x));
+        v = _mm256_shuffle_epi8(v, reversePixels);
+
+        const uint32_t bwWord =
+            ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, black))) ^ bwXorWord;
+        const uint32_t redWord =
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, redIndex))) ^
+            redXorWord;
+
+        // the byte order of little endian words matches the pixel order
+        for (size_t i = 0; i < 4; ++i)
+        {
+            bw[x / 8 + i] = bwWord >> (8 * i);
+            red[x / 8 + i] = redWord >> (8 * i);
+        }
+    }
+
+    return x;
+}
+#endif
+
+#if defined(COLOR_PLANES_SSE2)
+//--------------------------------------------------------------------------------------------------
+size_t packSse2(const uint8_t *pixels, size_t x, size_t width, uint8_t *bw, uint8_t *red,
+                uint8_t bwXor, uint8_t redXor)
+{
+    const __m128i black = _mm_set1_epi8(Black);
+    const __m128i redIndex = _mm_set1_epi8(Red);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + x));
+        const uint32_t blackMask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, black));
+        const uint32_t redMask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, redIndex));
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            bw[x / 8 + i] = BitReverse[static_cast<uint8_t>(~blackMask >> (8 * i))] ^ bwXor;
+            red[x / 8 + i] = BitReverse[static_cast<uint8_t>(redMask >> (8 * i))] ^ redXor;
+        }
+    }
+
+    return x;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+size_t packVectorized(const uint8_t *pixels, size_t width, uint8_t *bw, uint8_t *red,
+                      uint8_t bwXor, uint8_t redXor)
+{
+    size_t x = 0;
+
+#if defined(COLOR_PLANES_AVX2)
+    x = packAvx2(pixels, width, bw, red, bwXor, redXor);
+#endif
+
+#if defined(COLOR_PLANES_SSE2)
+    x = packSse2(pixels, x, width, bw, red, bwXor, redXor);
+#else
+    (void)pixels, (void)width, (void)bw, (void)red, (void)bwXor, (void)redXor;
+#endif
+
+    return x;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+void pack8bpp(const uint8_t *pixels, size_t width, size_t rows, uint8_t *bwPlane,
+              uint8_t *redPlane, PlaneFormat format)
+{
+    const size_t bytesPerRow = (width + 7) / 8;
+    const uint8_t bwXor = format.invertBlack ? 0xFF : 0;
+    const uint8_t redXor = format.invertRed ? 0xFF : 0;
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const uint8_t *rowPixels = pixels + row * width;
+        uint8_t *bw = bwPlane + row * bytesPerRow;
+        uint8_t *red = redPlane + row * bytesPerRow;
+
+        size_t x = packVectorized(rowPixels, width, bw, red, bwXor, redXor);
+
+        for (; x + 8 <= width; x += 8)
+        {
+            packSwar(rowPixels + x, bw[x / 8], red[x / 8]);
+            bw[x / 8] ^= bwXor;
+            red[x / 8] ^= redXor;
+        }
+
+        if (x < width)
+        {
+            // pad the last byte with white pixels
+            uint8_t tail[8] = {White, White, White, White, White, White, White, White};
+            std::memcpy(tail, rowPixels + x, width - x);
+
+            packSwar(tail, bw[x / 8], red[x / 8]);
+            bw[x / 8] ^= bwXor;
+            red[x / 8] ^= redXor;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void pack2bpp(const uint8_t *pixels, size_t width, size_t rows, uint8_t *bwPlane,
+              uint8_t *redPlane, PlaneFormat format)
+{
+    const size_t sourceBytesPerRow = (width + 3) / 4;
+    const size_t bytesPerRow = (width + 7) / 8;
+    const uint8_t bwXor = format.invertBlack ? 0xFF : 0;
+    const uint8_t redXor = format.invertRed ? 0xFF : 0;
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const uint8_t *source = pixels + row * sourceBytesPerRow;
+        uint8_t *bw = bwPlane + row * bytesPerRow;
+        uint8_t *red = redPlane + row * bytesPerRow;
+
+        for (size_t i = 0; i < bytesPerRow; ++i)
+        {
+            const uint8_t left = Pack2bpp[source[2 * i]];
+
+            // a missing right half at the end of the row is padded with white pixels
+            const uint8_t right = (2 * i + 1 < sourceBytesPerRow) ? Pack2bpp[source[2 * i + 1]]
+                                                                  : Pack2bpp[0];
+
+            uint8_t bwByte = (left & 0xF0) | (right >> 4);
+            uint8_t redByte = (left << 4) | (right & 0x0F);
+
+            if (i == bytesPerRow - 1 && width % 8 != 0)
+            {
+                // pixels behind the image width within the last source byte are white
+                const uint8_t padding = 0xFF >> (width % 8);
+                bwByte |= padding;
+                redByte &= ~padding;
+            }
+
+            bw[i] = bwByte ^ bwXor;
+            red[i] = redByte ^ redXor;
+        }
+    }
+}
+} // namespace color_planes
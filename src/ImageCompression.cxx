@@ -0,0 +1,165 @@
+#include "ssd-display-driver/ImageCompression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace image_compression
+{
+namespace
+{
+constexpr uint8_t RunControl = 0x80;
+constexpr uint8_t ZeroRunControl = 0xC0;
+constexpr uint8_t OnesRunControl = 0xE0;
+
+constexpr size_t MaxLiteral = 128;
+constexpr size_t MinRun = 3;
+constexpr size_t MaxRun = 66;
+constexpr size_t MaxShortRun = 32;
+
+/// \return Length of the run of equal bytes starting at \p source, up to MaxRun.
+size_t runLength(const uint8_t *source, size_t length)
+{
+    const size_t limit = std::min(length, MaxRun);
+
+    size_t run = 1;
+    while (run < limit && source[run] == source[0])
+        ++run;
+
+    return run;
+}
+
+/// \return True if a run at this position is cheaper than extending a literal.
+bool isRunWorthwhile(uint8_t value, size_t run)
+{
+    // blank and filled runs need no value byte
+    if (value == 0x00 || value == 0xFF)
+        return run >= 2;
+
+    return run >= MinRun;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+size_t compress(const uint8_t *source, size_t length, uint8_t *destination, size_t capacity)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < length)
+    {
+        const uint8_t value = source[in];
+        size_t run = runLength(source + in, length - in);
+
+        if (isRunWorthwhile(value, run))
+        {
+            if (value == 0x00 || value == 0xFF)
+            {
+                run = std::min(run, MaxShortRun);
+
+                if (out + 1 > capacity)
+                    return 0;
+
+                const uint8_t control = value == 0x00 ? ZeroRunControl : OnesRunControl;
+                destination[out++] = control | (run - 1);
+            }
+            else
+            {
+                if (out + 2 > capacity)
+                    return 0;
+
+                destination[out++] = RunControl | (run - MinRun);
+                destination[out++] = value;
+            }
+
+            in += run;
+            continue;
+        }
+
+        // collect a literal until the next worthwhile run
+        size_t literal = run;
+        while (in + literal < length && literal < MaxLiteral)
+        {
+            const size_t next = runLength(source + in + literal, length - in - literal);
+
+            if (isRunWorthwhile(source[in + literal], next))
+                break;
+
+            literal += next;
+        }
+
+        literal = std::min(literal, MaxLiteral);
+
+        if (out + 1 + literal > capacity)
+            return 0;
+
+        destination[out++] = literal - 1;
+        std::memcpy(destination + out, source + in, literal);
+        out += literal;
+        in += literal;
+    }
+
+    return out;
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t Decoder::decode(uint8_t *destination, size_t capacity)
+{
+    size_t length = 0;
+
+    while (length < capacity)
+    {
+        if (remaining == 0)
+        {
+            if (input == end)
+                break;
+
+            const uint8_t control = *input++;
+
+            if (control < RunControl)
+            {
+                isLiteral = true;
+                remaining = control + 1;
+            }
+            else if (control < ZeroRunControl)
+            {
+                // a truncated run is dropped
+                if (input == end)
+                    break;
+
+                isLiteral = false;
+                value = *input++;
+                remaining = (control & 0x3F) + MinRun;
+            }
+            else
+            {
+                isLiteral = false;
+                value = control < OnesRunControl ? 0x00 : 0xFF;
+                remaining = (control & 0x1F) + 1;
+            }
+        }
+
+        size_t count = std::min(remaining, capacity - length);
+
+        if (isLiteral)
+        {
+            // a truncated literal ends the data
+            count = std::min(count, static_cast<size_t>(end - input));
+            std::memcpy(destination + length, input, count);
+            input += count;
+
+            if (count == 0)
+            {
+                remaining = 0;
+                break;
+            }
+        }
+        else
+            std::memset(destination + length, value, count);
+
+        remaining -= count;
+        length += count;
+    }
+
+    return length;
+}
+} // namespace image_compression
@@ -1,5 +1,8 @@
 #include "ssd-display-driver/SSD1305.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace command
 {
 // clang-format off
@@ -8,6 +11,12 @@ constexpr auto SetUpperColumnStartAddress   = 0x10;
 constexpr auto SetMemoryAddressingMode      = 0x20;
 constexpr auto SetColumnAddress             = 0x21;
 constexpr auto SetPageAddress               = 0x22;
+constexpr auto RightHorizontalScroll        = 0x26;
+constexpr auto LeftHorizontalScroll         = 0x27;
+constexpr auto VerticalRightScroll          = 0x29;
+constexpr auto VerticalLeftScroll           = 0x2A;
+constexpr auto DeactivateScroll             = 0x2E;
+constexpr auto ActivateScroll               = 0x2F;
 constexpr auto SetDisplayStartLine          = 0x40;
 constexpr auto SetContrastControl           = 0x81;
 constexpr auto SetBrightness                = 0x82;
@@ -16,6 +25,7 @@ constexpr auto SetLut                       = 0x91;
 constexpr auto SetBankColor1To16            = 0x92;
 constexpr auto SetBankColor17To32           = 0x93;
 constexpr auto SetSegmentRemap              = 0xA0;
+constexpr auto SetVerticalScrollArea        = 0xA3;
 constexpr auto EntireDisplayOn              = 0xA4;
 constexpr auto SetNormalInverseDisplay      = 0xA6;
 constexpr auto SetMuxRatio                  = 0xA8;
@@ -38,6 +48,86 @@ constexpr auto ExitReadWriteModify          = 0xEE;
 // clang-format on
 } // namespace command
 
+namespace
+{
+/// Number of unchanged bytes between two changed spans of a page, up to which both spans are sent
+/// as one. Matches the cost of moving to the next span: a new column and page window takes 6
+/// command bytes in horizontal and vertical addressing mode (3 start address commands in page
+/// addressing mode), so sending the gap as data is never more expensive there.
+constexpr size_t SpanMergeGap = 6;
+
+/// Dummy byte of the SSD1306 scroll setup.
+constexpr uint8_t Dummy = 0x00;
+
+/// Scroll interval encoding of the SSD1305.
+uint8_t encodeScrollInterval(SSD1305::ScrollInterval interval)
+{
+    using Interval = SSD1305::ScrollInterval;
+
+    switch (interval)
+    {
+    case Interval::Frames2:
+        return 0b111;
+    case Interval::Frames3:
+        return 0b100;
+    case Interval::Frames4:
+        return 0b101;
+    case Interval::Frames5:
+        return 0b110;
+    case Interval::Frames6:
+        return 0b000;
+    case Interval::Frames25:
+    case Interval::Frames32:
+        return 0b001;
+    case Interval::Frames64:
+        return 0b010;
+    case Interval::Frames128:
+    case Interval::Frames256:
+    default:
+        return 0b011;
+    }
+}
+
+/// Scroll interval encoding of the SSD1306.
+uint8_t encodeScrollIntervalSsd1306(SSD1305::ScrollInterval interval)
+{
+    using Interval = SSD1305::ScrollInterval;
+
+    switch (interval)
+    {
+    case Interval::Frames2:
+        return 0b111;
+    case Interval::Frames3:
+        return 0b100;
+    case Interval::Frames4:
+        return 0b101;
+    case Interval::Frames5:
+    case Interval::Frames6:
+        return 0b000;
+    case Interval::Frames25:
+    case Interval::Frames32:
+        return 0b110;
+    case Interval::Frames64:
+        return 0b001;
+    case Interval::Frames128:
+        return 0b010;
+    case Interval::Frames256:
+    default:
+        return 0b011;
+    }
+}
+
+/// PageRenderer expanding compressed data, the context being an image_compression::Decoder.
+void decodePage(void *context, uint8_t, uint8_t *pageBuffer, size_t width)
+{
+    auto &decoder = *static_cast<image_compression::Decoder *>(context);
+    const size_t length = decoder.decode(pageBuffer, width);
+
+    // missing data is drawn blank
+    std::memset(pageBuffer + length, 0, width - length);
+}
+} // namespace
+
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setColumnStartAddress(uint8_t addr)
 {
@@ -48,96 +138,111 @@ void SSD1305::setColumnStartAddress(uint8_t addr)
 //--------------------------------------------------------------------------------------------------
 void SSD1305::resetColumnStartAddress()
 {
-    di.writeCommand(command::SetLowerColumnStartAddress | (columnStartAddress & 0xf));
-    di.writeCommand(command::SetUpperColumnStartAddress | (columnStartAddress >> 4));
+    beginTransaction();
+    writeCommand(command::SetLowerColumnStartAddress | (columnStartAddress & 0xf));
+    writeCommand(command::SetUpperColumnStartAddress | (columnStartAddress >> 4));
+    endTransaction();
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setMemoryAddressingMode(SSD1305::AddressingMode mode)
 {
-    di.writeCommand(command::SetMemoryAddressingMode);
-    di.writeCommand(static_cast<uint8_t>(mode) & 0b11);
+    addressingMode = mode;
+
+    const uint8_t arg = static_cast<uint8_t>(mode) & 0b11;
+    writeRegister(Register::AddressingMode, {command::SetMemoryAddressingMode, arg});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setColumnAddress(uint8_t addrStart, uint8_t addrEnd)
 {
-    di.writeCommand(command::SetColumnAddress);
-    di.writeCommand(addrStart);
-    di.writeCommand(addrEnd);
+    columnWindowStart = addrStart;
+    columnWindowEnd = addrEnd;
+
+    // always written, since it moves the address pointer as well
+    storeRegister(Register::ColumnWindow, {command::SetColumnAddress, addrStart, addrEnd});
+
+    beginTransaction();
+    writeCommand(command::SetColumnAddress);
+    writeCommand(addrStart);
+    writeCommand(addrEnd);
+    endTransaction();
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setPageAddress(uint8_t addrStart, uint8_t addrEnd)
 {
-    di.writeCommand(command::SetPageAddress);
-    di.writeCommand(addrStart);
-    di.writeCommand(addrEnd);
+    pageWindowStart = addrStart;
+    pageWindowEnd = addrEnd;
+
+    // always written, since it moves the address pointer as well
+    storeRegister(Register::PageWindow, {command::SetPageAddress, addrStart, addrEnd});
+
+    beginTransaction();
+    writeCommand(command::SetPageAddress);
+    writeCommand(addrStart);
+    writeCommand(addrEnd);
+    endTransaction();
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setDisplayStartLine(uint8_t line)
 {
     line &= 0x3f;
-    di.writeCommand(command::SetDisplayStartLine | line);
+    writeRegister(Register::DisplayStartLine,
+                  {static_cast<uint8_t>(command::SetDisplayStartLine | line)});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setContrastControl(uint8_t contrast)
 {
-    di.writeCommand(command::SetContrastControl);
-    di.writeCommand(contrast);
+    writeRegister(Register::Contrast, {command::SetContrastControl, contrast});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setBrightness(uint8_t brightness)
 {
-    di.writeCommand(command::SetBrightness);
-    di.writeCommand(brightness);
+    writeRegister(Register::Brightness, {command::SetBrightness, brightness});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setLUT(uint8_t bank0, uint8_t colorA, uint8_t colorB, uint8_t colorC)
 {
-    di.writeCommand(command::SetLut);
-    di.writeCommand(bank0);
-    di.writeCommand(colorA);
-    di.writeCommand(colorB);
-    di.writeCommand(colorC);
+    writeRegister(Register::Lut, {command::SetLut, bank0, colorA, colorB, colorC});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setSegmentRemap(bool remap)
 {
-    di.writeCommand(command::SetSegmentRemap | (remap ? 1 : 0));
+    writeRegister(Register::SegmentRemap,
+                  {static_cast<uint8_t>(command::SetSegmentRemap | (remap ? 1 : 0))});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setEntireDisplayOn(bool on)
 {
-    di.writeCommand(command::EntireDisplayOn | (on ? 1 : 0));
+    writeRegister(Register::EntireDisplayOn,
+                  {static_cast<uint8_t>(command::EntireDisplayOn | (on ? 1 : 0))});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setInverseDisplay(bool inverse)
 {
-    di.writeCommand(command::SetNormalInverseDisplay | (inverse ? 1 : 0));
+    writeRegister(Register::InverseDisplay,
+                  {static_cast<uint8_t>(command::SetNormalInverseDisplay | (inverse ? 1 : 0))});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setMultiplexRatio(uint8_t ratio)
 {
-    di.writeCommand(command::SetMuxRatio);
-    di.writeCommand(ratio);
+    writeRegister(Register::MultiplexRatio, {command::SetMuxRatio, ratio});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setDimMode(uint8_t contrast, uint8_t brightness)
 {
-    di.writeCommand(command::DimModeSetting);
-    di.writeCommand(0); // reserved
-    di.writeCommand(contrast);
-    di.writeCommand(brightness);
+    constexpr uint8_t Reserved = 0;
+    writeRegister(Register::DimMode, {command::DimModeSetting, Reserved, contrast, brightness});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -163,7 +268,7 @@ void SSD1305::setDisplayState(SSD1305::DisplayState state)
         return;
     }
 
-    di.writeCommand(cmd);
+    writeRegister(Register::DisplayState, {cmd});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -175,7 +280,7 @@ void SSD1305::setPageStartAddress(uint8_t addr)
 //--------------------------------------------------------------------------------------------------
 void SSD1305::resetPageStartAddress()
 {
-    di.writeCommand(command::SetPageStartAddress | (pageStartAddress & 0b111));
+    writeCommand(command::SetPageStartAddress | (pageStartAddress & 0b111));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -186,14 +291,14 @@ void SSD1305::setComOutputMode(SSD1305::ComMode mode)
     if (mode == SSD1305::ComMode::Remap)
         arg |= 0b1000;
 
-    di.writeCommand(command::SetComOutputDirection | arg);
+    writeRegister(Register::ComOutputMode,
+                  {static_cast<uint8_t>(command::SetComOutputDirection | arg)});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setDisplayOffset(uint8_t offset)
 {
-    di.writeCommand(command::SetDisplayOffset);
-    di.writeCommand(offset);
+    writeRegister(Register::DisplayOffset, {command::SetDisplayOffset, offset});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -202,8 +307,8 @@ void SSD1305::setDisplayClockDivide(uint8_t ratio, uint8_t fOsc)
     ratio &= 0xf;
     fOsc &= 0xf;
 
-    di.writeCommand(command::SetDisplayClockDivider);
-    di.writeCommand(ratio | (fOsc << 4));
+    writeRegister(Register::DisplayClockDivide,
+                  {command::SetDisplayClockDivider, static_cast<uint8_t>(ratio | (fOsc << 4))});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -217,15 +322,14 @@ void SSD1305::setAreaColorModeAndPowerMode(ColorMode color, PowerMode power)
     if (power == SSD1305::PowerMode::LowPower)
         arg |= 0b101;
 
-    di.writeCommand(command::SetAreaColorMode);
-    di.writeCommand(arg);
+    writeRegister(Register::AreaColorModeAndPowerMode, {command::SetAreaColorMode, arg});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::setPrechargingPeriod(uint8_t phase1, uint8_t phase2)
 {
-    di.writeCommand(command::SetPrechargingPeriod);
-    di.writeCommand(phase1 | (phase2 << 4));
+    writeRegister(Register::PrechargingPeriod,
+                  {command::SetPrechargingPeriod, static_cast<uint8_t>(phase1 | (phase2 << 4))});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -239,8 +343,7 @@ void SSD1305::setComPinConfig(bool alternative, bool lrRemap)
     if (lrRemap)
         arg |= 1 << 5;
 
-    di.writeCommand(command::SetComPinsConfig);
-    di.writeCommand(arg);
+    writeRegister(Register::ComPinConfig, {command::SetComPinsConfig, arg});
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -265,45 +368,801 @@ void SSD1305::setVcomhDeselectLevel(VcomhLevel level)
 
     arg <<= 2;
 
-    di.writeCommand(command::SetVcomhDeselectLevel);
-    di.writeCommand(arg);
+    writeRegister(Register::VcomhDeselectLevel, {command::SetVcomhDeselectLevel, arg});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::setupHorizontalScroll(ScrollDirection direction, uint8_t startPage,
+                                    uint8_t endPage, ScrollInterval interval,
+                                    uint8_t columnOffset)
+{
+    const uint8_t cmd = direction == ScrollDirection::Right ? command::RightHorizontalScroll
+                                                             : command::LeftHorizontalScroll;
+    const uint8_t start = startPage & 0b111;
+    const uint8_t end = endPage & 0b111;
+
+    if (variant == Variant::SSD1306)
+    {
+        writeScrollSetup(
+            {cmd, Dummy, start, encodeScrollIntervalSsd1306(interval), end, 0x00, 0xFF});
+        return;
+    }
+
+    writeScrollSetup({cmd, columnOffset, start, encodeScrollInterval(interval), end});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::setupDiagonalScroll(ScrollDirection direction, uint8_t startPage, uint8_t endPage,
+                                  ScrollInterval interval, uint8_t verticalOffset,
+                                  uint8_t columnOffset)
+{
+    const uint8_t cmd = direction == ScrollDirection::Right ? command::VerticalRightScroll
+                                                             : command::VerticalLeftScroll;
+    const uint8_t start = startPage & 0b111;
+    const uint8_t end = endPage & 0b111;
+    const uint8_t offset = verticalOffset & 0x3f;
+
+    if (variant == Variant::SSD1306)
+    {
+        writeScrollSetup(
+            {cmd, Dummy, start, encodeScrollIntervalSsd1306(interval), end, offset});
+        return;
+    }
+
+    writeScrollSetup({cmd, columnOffset, start, encodeScrollInterval(interval), end, offset});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::setVerticalScrollArea(uint8_t fixedRows, uint8_t scrollRows)
+{
+    writeRegister(Register::VerticalScrollArea,
+                  {command::SetVerticalScrollArea, static_cast<uint8_t>(fixedRows & 0x3f),
+                   static_cast<uint8_t>(scrollRows & 0x7f)});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::activateScroll()
+{
+    isScrolling = true;
+    writeRegister(Register::ScrollActivation, {command::ActivateScroll});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::deactivateScroll()
+{
+    if (isScrolling)
+        isShadowValid = false;
+
+    isScrolling = false;
+    writeRegister(Register::ScrollActivation, {command::DeactivateScroll});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::writeScrollSetup(std::initializer_list<uint8_t> bytes)
+{
+    beginTransaction();
+
+    // changing the setup while scrolling is not allowed
+    deactivateScroll();
+
+    // always written, so a setup replaced by another command is applied again
+    storeRegister(Register::ScrollSetup, bytes);
+
+    for (const auto cmd : bytes)
+        writeCommand(cmd);
+
+    endTransaction();
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::enterReadWriteModify()
 {
-    di.writeCommand(command::EnterReadWriteModify);
+    writeCommand(command::EnterReadWriteModify);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::exitReadWriteModify()
 {
-    di.writeCommand(command::ExitReadWriteModify);
+    writeCommand(command::ExitReadWriteModify);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::nop()
 {
-    di.writeCommand(command::Nop);
+    writeCommand(command::Nop);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::setChargePump(bool enable)
+{
+    // the SSD1305 is supplied externally
+    if (variant != Variant::SSD1306)
+        return;
+
+    writeRegister(Register::ChargePump,
+                  {command::ChargePumpSetting, static_cast<uint8_t>(enable ? 0x14 : 0x10)});
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::draw(uint8_t data)
 {
+    if (isScrolling)
+        deactivateScroll();
+
+    invalidateByteCache();
+
+    waitForImageTransfer();
+    flushTransaction();
     di.writeData(data);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1305::draw(const uint8_t *data, size_t length)
 {
+    if (isScrolling)
+        deactivateScroll();
+
+    invalidateByteCache();
+
+    waitForImageTransfer();
+    flushTransaction();
     di.writeData(data, length);
 }
 
+//--------------------------------------------------------------------------------------------------
+void SSD1305::beginTransaction()
+{
+    ++transactionDepth;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::endTransaction()
+{
+    if (transactionDepth == 0)
+        return;
+
+    if (--transactionDepth == 0)
+        flushTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::restore(const RegisterSnapshot &registerSnapshot)
+{
+    registers = registerSnapshot;
+
+    if (registers.variant != variant)
+    {
+        // encoded for the other controller
+        registers.variant = variant;
+        registers.lengths[static_cast<size_t>(Register::ChargePump)] = 0;
+        registers.lengths[static_cast<size_t>(Register::ScrollSetup)] = 0;
+        registers.lengths[static_cast<size_t>(Register::ScrollActivation)] = 0;
+    }
+
+    beginTransaction();
+
+    for (size_t i = 0; i < RegisterSnapshot::NumberOfRegisters; ++i)
+        for (size_t j = 0; j < registers.lengths[i]; ++j)
+            writeCommand(registers.commands[i][j]);
+
+    endTransaction();
+
+    // take over the state the driver keeps for the image transfers
+    const auto &mode = registers.commands[static_cast<size_t>(Register::AddressingMode)];
+    if (registers.lengths[static_cast<size_t>(Register::AddressingMode)] != 0)
+        addressingMode = static_cast<AddressingMode>(mode[1]);
+
+    const auto &columns = registers.commands[static_cast<size_t>(Register::ColumnWindow)];
+    if (registers.lengths[static_cast<size_t>(Register::ColumnWindow)] != 0)
+    {
+        columnWindowStart = columns[1];
+        columnWindowEnd = columns[2];
+    }
+
+    const auto &pages = registers.commands[static_cast<size_t>(Register::PageWindow)];
+    if (registers.lengths[static_cast<size_t>(Register::PageWindow)] != 0)
+    {
+        pageWindowStart = pages[1];
+        pageWindowEnd = pages[2];
+    }
+
+    const auto activation = static_cast<size_t>(Register::ScrollActivation);
+    isScrolling = registers.lengths[activation] != 0 &&
+                  registers.commands[activation][0] == command::ActivateScroll;
+
+    isWindowNarrowed = false;
+    isShadowValid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::invalidateRegisters()
+{
+    registers.lengths.fill(0);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305::storeRegister(Register reg, std::initializer_list<uint8_t> bytes)
+{
+    const auto index = static_cast<size_t>(reg);
+    auto &stored = registers.commands[index];
+    auto &length = registers.lengths[index];
+
+    if (length == bytes.size() && std::equal(bytes.begin(), bytes.end(), stored.begin()))
+        return false;
+
+    length = std::min(bytes.size(), stored.size());
+    std::copy_n(bytes.begin(), length, stored.begin());
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::writeRegister(Register reg, std::initializer_list<uint8_t> bytes)
+{
+    if (!storeRegister(reg, bytes))
+    {
+        ++numberOfDroppedWrites;
+        return;
+    }
+
+    // a command and its parameters are sent with one interface call, e.g. one I2C transaction
+    beginTransaction();
+
+    for (const auto cmd : bytes)
+        writeCommand(cmd);
+
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::writeCommand(uint8_t cmd)
+{
+    if (transactionDepth == 0)
+    {
+        waitForImageTransfer();
+        di.writeCommand(cmd);
+        return;
+    }
+
+    if (transactionLength == transactionBuffer.size())
+    {
+        if (segmentedLength == 0)
+            flushTransaction();
+        else
+        {
+            // send the collected segments and move the following commands to the front, so a
+            // command is not split from its parameters
+            waitForImageTransfer();
+
+            if (numberOfSegments > 0)
+                di.writeSegments(segments.data(), numberOfSegments);
+
+            std::copy(transactionBuffer.begin() + segmentedLength,
+                      transactionBuffer.begin() + transactionLength, transactionBuffer.begin());
+            transactionLength -= segmentedLength;
+            segmentedLength = 0;
+            numberOfSegments = 0;
+        }
+    }
+
+    transactionBuffer[transactionLength++] = cmd;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::appendData(const uint8_t *data, size_t length)
+{
+    if (transactionDepth == 0)
+    {
+        draw(data, length);
+        return;
+    }
+
+    if (isScrolling)
+        deactivateScroll();
+
+    invalidateByteCache();
+
+    // the commands collected since the last segment precede the data
+    appendSegment(SSDInterface::Segment::Type::Command, transactionBuffer.data() + segmentedLength,
+                  transactionLength - segmentedLength);
+    segmentedLength = transactionLength;
+
+    appendSegment(SSDInterface::Segment::Type::Data, data, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::appendSegment(SSDInterface::Segment::Type type, const uint8_t *data, size_t length)
+{
+    if (length == 0)
+        return;
+
+    if (numberOfSegments == segments.size())
+    {
+        waitForImageTransfer();
+        di.writeSegments(segments.data(), numberOfSegments);
+        numberOfSegments = 0;
+    }
+
+    segments[numberOfSegments++] = {type, data, length};
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::flushTransaction()
+{
+    if (transactionLength == 0 && numberOfSegments == 0)
+        return;
+
+    waitForImageTransfer();
+
+    // commands before segmentedLength went out with segments already
+    if (numberOfSegments == 0)
+    {
+        if (transactionLength > segmentedLength)
+            di.writeCommands(transactionBuffer.data() + segmentedLength,
+                             transactionLength - segmentedLength);
+    }
+    else
+    {
+        appendSegment(SSDInterface::Segment::Type::Command,
+                      transactionBuffer.data() + segmentedLength,
+                      transactionLength - segmentedLength);
+        di.writeSegments(segments.data(), numberOfSegments);
+    }
+
+    transactionLength = 0;
+    segmentedLength = 0;
+    numberOfSegments = 0;
+}
+
 //--------------------------------------------------------------------------------------------------
 void SSD1305::submitImage(const uint8_t *image, size_t length)
 {
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    // before deciding on a differential update, since it invalidates the GDDRAM content
+    if (isScrolling)
+        deactivateScroll();
+
+    if (shadow == nullptr || shadowWidth == 0 || length != shadowLength)
+    {
+        submitFullImage(image, length);
+        return;
+    }
+
+    if (!isShadowValid)
+    {
+        if (addressingMode == AddressingMode::Horizontal)
+            submitFullImage(image, length);
+        else
+        {
+            // the image is page-major, so it is sent page by page in the other modes
+            beginTransaction();
+
+            for (size_t page = 0; page < shadowLength / shadowWidth; ++page)
+                drawSpan(page, 0, image + page * shadowWidth, shadowWidth);
+
+            endTransaction();
+        }
+
+        std::memcpy(shadow, image, length);
+        isShadowValid = true;
+        return;
+    }
+
+    submitDifferentialImage(image);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::drawPage(uint8_t page, uint8_t column, const uint8_t *data, size_t length)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    // the GDDRAM does not match the last image anymore
+    isShadowValid = false;
+
+    drawSpan(page, column, data, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitRowMajorImage(const uint8_t *image, uint8_t width, uint8_t height,
+                                  bit_transpose::Mirror mirror)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    std::array<uint8_t, MaxColumns> pageBuffer;
+
+    if (width > pageBuffer.size())
+        return;
+
+    if (isScrolling)
+        deactivateScroll();
+
+    const size_t numberOfPages = (height + 7) / 8;
+    const bool isDifferential =
+        shadow != nullptr && width == shadowWidth && numberOfPages * width == shadowLength;
+
+    for (size_t page = 0; page < numberOfPages; ++page)
+    {
+        bit_transpose::convertPage(image, width, height, page, pageBuffer.data(), mirror);
+
+        if (isDifferential && isShadowValid)
+            submitDifferentialPage(page, pageBuffer.data());
+        else
+        {
+            drawSpan(page, 0, pageBuffer.data(), width);
+
+            if (isDifferential)
+                std::memcpy(shadow + page * width, pageBuffer.data(), width);
+        }
+
+        // the page buffer is reused, so no span may be left in an open transaction
+        flushTransaction();
+    }
+
+    if (isDifferential)
+        isShadowValid = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitStreamedImage(PageRenderer renderer, void *context, uint8_t width,
+                                  uint8_t numberOfPages)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    std::array<std::array<uint8_t, MaxColumns>, 2> pageBuffers;
+
+    if (width > MaxColumns)
+        return;
+
+    if (isScrolling)
+        deactivateScroll();
+
+    const bool isDifferential =
+        shadow != nullptr && width == shadowWidth && numberOfPages * width == shadowLength;
+
+    // the spans of differential updates are sent synchronously
+    const bool isOverlapped = asyncDi != nullptr && !(isDifferential && isShadowValid);
+
+    for (uint8_t page = 0; page < numberOfPages; ++page)
+    {
+        // the buffer of the page before the previous one, its transfer has completed
+        uint8_t *pageBuffer = pageBuffers[page % 2].data();
+        renderer(context, page, pageBuffer, width);
+
+        if (isDifferential && isShadowValid)
+            submitDifferentialPage(page, pageBuffer);
+        else
+        {
+            if (isOverlapped)
+            {
+                moveToSpan(page, 0, width);
+                waitForImageTransfer();
+                flushTransaction();
+                invalidateByteCache();
+
+                isImageTransferRunning = true;
+                asyncDi->startWriteData(pageBuffer, width);
+            }
+            else
+                drawSpan(page, 0, pageBuffer, width);
+
+            if (isDifferential)
+                std::memcpy(shadow + page * width, pageBuffer, width);
+        }
+
+        // the page buffers are reused, so no span may be left in an open transaction
+        flushTransaction();
+    }
+
+    // the page buffers are gone after returning
+    waitForImageTransfer();
+
+    if (isDifferential)
+        isShadowValid = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitCompressedImage(const uint8_t *data, size_t length, uint8_t width,
+                                    uint8_t numberOfPages)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    image_compression::Decoder decoder(data, length);
+    submitStreamedImage(decodePage, &decoder, width, numberOfPages);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitImageAsync(const uint8_t *image, size_t length)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    if (asyncDi == nullptr)
+    {
+        submitImage(image, length);
+        return;
+    }
+
+    waitForImageTransfer();
+
+    if (isScrolling)
+        deactivateScroll();
+
+    invalidateByteCache();
+    prepareFullImage();
+
+    if (shadow != nullptr && length == shadowLength)
+    {
+        std::memcpy(shadow, image, length);
+        isShadowValid = true;
+    }
+
+    // the addressing commands have to precede the image on the bus, even inside a transaction
+    flushTransaction();
+
+    isImageTransferRunning = true;
+    asyncDi->startWriteData(image, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305::isImageTransferComplete()
+{
+    if (isImageTransferRunning && asyncDi->isTransferComplete())
+        isImageTransferRunning = false;
+
+    return !isImageTransferRunning;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::waitForImageTransfer()
+{
+    if (!isImageTransferRunning)
+        return;
+
+    asyncDi->waitForTransfer();
+    isImageTransferRunning = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::enableDifferentialUpdate(uint8_t *shadowBuffer, size_t length, uint8_t width)
+{
+    shadow = shadowBuffer;
+    shadowLength = length;
+    shadowWidth = width;
+    isShadowValid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::disableDifferentialUpdate()
+{
+    shadow = nullptr;
+    isShadowValid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::invalidateShadow()
+{
+    isShadowValid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitFullImage(const uint8_t *image, size_t length)
+{
+    beginTransaction();
+    prepareFullImage();
+    appendData(image, length);
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::prepareFullImage()
+{
+    beginTransaction();
+
+    if (isWindowNarrowed)
+    {
+        setColumnAddress(columnWindowStart, columnWindowEnd);
+        setPageAddress(pageWindowStart, pageWindowEnd);
+        isWindowNarrowed = false;
+    }
+
     resetPageStartAddress();
     resetColumnStartAddress();
 
-    draw(image, length);
-}
\ No newline at end of file
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitDifferentialImage(const uint8_t *image)
+{
+    const size_t numberOfPages = shadowLength / shadowWidth;
+
+    // the spans of all pages are sent together, the image stays valid until the end
+    beginTransaction();
+
+    for (size_t page = 0; page < numberOfPages; ++page)
+        submitDifferentialPage(page, image + page * shadowWidth);
+
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::submitDifferentialPage(size_t page, const uint8_t *newRow)
+{
+    uint8_t *oldRow = shadow + page * shadowWidth;
+
+    size_t column = 0;
+    while (column < shadowWidth)
+    {
+        while (column < shadowWidth && newRow[column] == oldRow[column])
+            ++column;
+
+        if (column == shadowWidth)
+            break;
+
+        const size_t spanStart = column;
+        size_t spanEnd = column;
+        size_t equalBytes = 0;
+
+        for (++column; column < shadowWidth; ++column)
+        {
+            if (newRow[column] != oldRow[column])
+            {
+                spanEnd = column;
+                equalBytes = 0;
+            }
+            else if (++equalBytes > SpanMergeGap)
+                break;
+        }
+
+        drawSpan(page, spanStart, newRow + spanStart, spanEnd - spanStart + 1);
+        column = spanEnd + 1;
+    }
+
+    std::memcpy(oldRow, newRow, shadowWidth);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::drawSpan(uint8_t page, uint8_t column, const uint8_t *data, size_t length)
+{
+    beginTransaction();
+    moveToSpan(page, column, length);
+    appendData(data, length);
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::moveToSpan(uint8_t page, uint8_t column, size_t length)
+{
+    beginTransaction();
+
+    if (addressingMode == AddressingMode::Page)
+    {
+        // column and page windows are ignored in page addressing mode,
+        // so only the start pointers have to be moved
+        const uint8_t absoluteColumn = columnStartAddress + column;
+
+        writeCommand(command::SetPageStartAddress | ((pageStartAddress + page) & 0b111));
+        writeCommand(command::SetLowerColumnStartAddress | (absoluteColumn & 0xf));
+        writeCommand(command::SetUpperColumnStartAddress | (absoluteColumn >> 4));
+    }
+    else
+    {
+        const uint8_t absoluteColumn = columnWindowStart + column;
+        const uint8_t absolutePage = pageWindowStart + page;
+
+        writeCommand(command::SetColumnAddress);
+        writeCommand(absoluteColumn);
+        writeCommand(absoluteColumn + length - 1);
+
+        writeCommand(command::SetPageAddress);
+        writeCommand(absolutePage);
+        writeCommand(absolutePage);
+
+        isWindowNarrowed = true;
+    }
+
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305::modifyPixel(uint8_t x, uint8_t y, PixelOperation operation)
+{
+    return modifyByte(y / 8, x, 1 << (y % 8), operation);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305::modifyByte(uint8_t page, uint8_t column, uint8_t mask, PixelOperation operation)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::PixelUpdate);
+
+    if (isScrolling)
+        deactivateScroll();
+
+    moveToSpan(page, column, 1);
+
+    bool isReadModifyWrite = false;
+    uint8_t value = readByte(page, column, isReadModifyWrite);
+
+    const size_t shadowIndex = size_t{page} * shadowWidth + column;
+    const bool isShadowed = isShadowValid && column < shadowWidth && shadowIndex < shadowLength;
+
+    // without another copy of the GDDRAM, evicting a byte with pixels set would lose them
+    auto &cached = byteCache[byteCacheIndex(page, column)];
+    if (!isReadModifyWrite && !isShadowed && cached.isValid && cached.value != 0 &&
+        (cached.page != page || cached.column != column))
+    {
+        ++numberOfRejectedPixelUpdates;
+        return false;
+    }
+
+    switch (operation)
+    {
+    case PixelOperation::Set:
+        value |= mask;
+        break;
+
+    case PixelOperation::Clear:
+        value &= ~mask;
+        break;
+
+    case PixelOperation::Toggle:
+        value ^= mask;
+        break;
+    }
+
+    // not using draw(), which invalidates the cache
+    flushTransaction();
+    waitForImageTransfer();
+    di.writeData(value);
+
+    if (isReadModifyWrite)
+        exitReadWriteModify();
+
+    // keep the copies of the GDDRAM up to date
+    if (isShadowed)
+        shadow[shadowIndex] = value;
+
+    cached = CachedByte{page, column, value, true};
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t SSD1305::readByte(uint8_t page, uint8_t column, bool &isReadModifyWrite)
+{
+    if (isReadSupported)
+    {
+        // read-modify-write mode keeps the address pointer while reading and returns it to the
+        // original location when leaving
+        enterReadWriteModify();
+        flushTransaction();
+        waitForImageTransfer();
+
+        // the first byte read is a dummy byte
+        uint8_t readBuffer[2];
+        if (di.readData(readBuffer, sizeof(readBuffer)))
+        {
+            isReadModifyWrite = true;
+            return readBuffer[1];
+        }
+
+        // no need to try again
+        isReadSupported = false;
+        exitReadWriteModify();
+    }
+
+    const size_t shadowIndex = size_t{page} * shadowWidth + column;
+    if (shadow != nullptr && isShadowValid && column < shadowWidth && shadowIndex < shadowLength)
+        return shadow[shadowIndex];
+
+    const auto &cached = byteCache[byteCacheIndex(page, column)];
+    if (cached.isValid && cached.page == page && cached.column == column)
+        return cached.value;
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305::invalidateByteCache()
+{
+    for (auto &cached : byteCache)
+        cached.isValid = false;
+}
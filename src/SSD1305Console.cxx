@@ -0,0 +1,68 @@
+#include "ssd-display-driver/SSD1305Console.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Console::clear()
+{
+    lineBuffer.fill(0);
+
+    for (uint8_t page = 0; page < NumberOfPages; ++page)
+        display.drawPage(page, 0, lineBuffer.data(), std::min<size_t>(width, lineBuffer.size()));
+
+    // the line buffer is reused, it must not be left in an open transaction
+    display.flushTransaction();
+
+    display.setDisplayStartLine(0);
+    lineCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Console::writeLine(const char *text)
+{
+    lineBuffer.fill(0);
+
+    const size_t lineWidth = std::min<size_t>(width, lineBuffer.size());
+    size_t column = 0;
+
+    for (; *text != '\0' && column + font.glyphWidth <= lineWidth; ++text)
+    {
+        if (*text >= font.first && *text <= font.last)
+        {
+            const size_t glyph = static_cast<size_t>(*text - font.first);
+            std::memcpy(&lineBuffer[column], font.glyphs + glyph * font.glyphWidth,
+                        font.glyphWidth);
+        }
+
+        column += font.glyphWidth;
+    }
+
+    appendLine(lineBuffer.data());
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Console::writeLine(const uint8_t *pageData)
+{
+    appendLine(pageData);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Console::appendLine(const uint8_t *pageData)
+{
+    const uint8_t page = lineCount % NumberOfPages;
+    display.drawPage(page, 0, pageData, std::min<size_t>(width, lineBuffer.size()));
+
+    // the line buffer is reused, it must not be left in an open transaction
+    display.flushTransaction();
+
+    ++lineCount;
+
+    // until the display is full, the lines are added below the first one
+    if (lineCount <= visibleLines)
+        return;
+
+    // the new line becomes the bottom one, wrapping around the ring of pages
+    const uint8_t topPage = (page + NumberOfPages + 1 - visibleLines) % NumberOfPages;
+    display.setDisplayStartLine(topPage * 8);
+}
@@ -0,0 +1,526 @@
+#include "ssd-display-driver/SSD1305Emulator.hpp"
+
+#include <initializer_list>
+
+namespace command
+{
+// clang-format off
+constexpr auto SetLowerColumnStartAddress   = 0x00;
+constexpr auto SetUpperColumnStartAddress   = 0x10;
+constexpr auto SetMemoryAddressingMode      = 0x20;
+constexpr auto SetColumnAddress             = 0x21;
+constexpr auto SetPageAddress               = 0x22;
+constexpr auto RightHorizontalScroll        = 0x26;
+constexpr auto LeftHorizontalScroll         = 0x27;
+constexpr auto VerticalRightScroll          = 0x29;
+constexpr auto VerticalLeftScroll           = 0x2A;
+constexpr auto DeactivateScroll             = 0x2E;
+constexpr auto ActivateScroll               = 0x2F;
+constexpr auto SetDisplayStartLine          = 0x40;
+constexpr auto SetContrastControl           = 0x81;
+constexpr auto SetBrightness                = 0x82;
+constexpr auto ChargePumpSetting            = 0x8D;
+constexpr auto SetLut                       = 0x91;
+constexpr auto SetBankColor1To16            = 0x92;
+constexpr auto SetBankColor17To32           = 0x93;
+constexpr auto SetSegmentRemap              = 0xA0;
+constexpr auto SetVerticalScrollArea        = 0xA3;
+constexpr auto EntireDisplayOn              = 0xA4;
+constexpr auto SetNormalInverseDisplay      = 0xA6;
+constexpr auto SetMuxRatio                  = 0xA8;
+constexpr auto DimModeSetting               = 0xAB;
+constexpr auto SetDisplayDimmed             = 0xAC;
+constexpr auto MasterConfig                 = 0xAD;
+constexpr auto SetDisplayOff                = 0xAE;
+constexpr auto SetDisplayOn                 = 0xAF;
+constexpr auto SetPageStartAddress          = 0xB0;
+constexpr auto SetComOutputDirection        = 0xC0;
+constexpr auto SetDisplayOffset             = 0xD3;
+constexpr auto SetDisplayClockDivider       = 0xD5;
+constexpr auto SetAreaColorMode             = 0xD8;
+constexpr auto SetPrechargingPeriod         = 0xD9;
+constexpr auto SetComPinsConfig             = 0xDA;
+constexpr auto SetVcomhDeselectLevel        = 0xDB;
+constexpr auto EnterReadWriteModify         = 0xE0;
+constexpr auto ExitReadWriteModify          = 0xEE;
+// clang-format on
+} // namespace command
+
+namespace
+{
+/// I2C slave address and control byte sent with every transaction.
+constexpr size_t I2cFramingBytes = 2;
+
+/// Clock cycles for start and stop condition of an I2C transaction.
+constexpr size_t I2cStartStopCycles = 2;
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+SSD1305Emulator::SSD1305Emulator(Variant variant, Bus bus, uint32_t clockHz)
+    : variant(variant), bus(bus), clockHz(clockHz)
+{
+    reset();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::setBus(Bus bus, uint32_t clockHz)
+{
+    this->bus = bus;
+    this->clockHz = clockHz;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::reset()
+{
+    for (auto &pageRam : gddram)
+        pageRam.fill(0);
+
+    mode = AddressingMode::Page;
+    column = 0;
+    page = 0;
+    columnStart = 0;
+    columnEnd = Columns - 1;
+    pageStart = 0;
+    pageEnd = Pages - 1;
+
+    startLine = 0;
+    displayOffset = 0;
+    multiplexRatio = Rows - 1;
+    contrastValue = 0x80;
+    displayOn = false;
+    segmentRemap = false;
+    comRemap = false;
+    inverse = false;
+    entireDisplayOn = false;
+    scrollActive = false;
+    readModifyWrite = false;
+    isDummyReadDue = true;
+
+    expectedParameters = 0;
+    parameterCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeCommand(uint8_t cmd)
+{
+    recordTransaction(ByteType::Command, &cmd, 1);
+    decodeCommand(cmd);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeCommands(const uint8_t *cmds, size_t length)
+{
+    recordTransaction(ByteType::Command, cmds, length);
+
+    for (size_t i = 0; i < length; ++i)
+        decodeCommand(cmds[i]);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeData(uint8_t data)
+{
+    recordTransaction(ByteType::Data, &data, 1);
+    writeRam(data);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeData(const uint8_t *data, size_t length)
+{
+    recordTransaction(ByteType::Data, data, length);
+
+    for (size_t i = 0; i < length; ++i)
+        writeRam(data[i]);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeSegments(const Segment *segments, size_t numberOfSegments)
+{
+    bool isEmpty = true;
+    Segment::Type previousType = Segment::Type::Command;
+
+    for (size_t i = 0; i < numberOfSegments; ++i)
+    {
+        const Segment &segment = segments[i];
+
+        if (segment.length == 0)
+            continue;
+
+        const bool isCommand = segment.type == Segment::Type::Command;
+        const bool isFramed = isEmpty || segment.type != previousType;
+
+        recordBytes(isCommand ? ByteType::Command : ByteType::Data, segment.data, segment.length,
+                    isFramed);
+
+        for (size_t j = 0; j < segment.length; ++j)
+        {
+            if (isCommand)
+                decodeCommand(segment.data[j]);
+            else
+                writeRam(segment.data[j]);
+        }
+
+        isEmpty = false;
+        previousType = segment.type;
+    }
+
+    if (!isEmpty)
+        finishTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305Emulator::readData(uint8_t *data, size_t length)
+{
+    if (bus != Bus::Parallel)
+        return false;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (isDummyReadDue)
+        {
+            data[i] = 0;
+            isDummyReadDue = false;
+            continue;
+        }
+
+        data[i] = ram(column, page);
+
+        if (!readModifyWrite)
+            advancePointer();
+    }
+
+    recordTransaction(ByteType::Read, data, length);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::markFrame()
+{
+    finishedFrames.push_back(frameTraffic);
+    frameTraffic = Traffic{};
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::clearTrace()
+{
+    byteTrace.clear();
+    finishedFrames.clear();
+    frameTraffic = Traffic{};
+    total = Traffic{};
+    transactionIndex = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t SSD1305Emulator::ram(uint8_t column, uint8_t page) const
+{
+    if (column >= Columns || page >= Pages)
+        return 0;
+
+    return gddram[page][column];
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305Emulator::ramPixel(uint8_t column, uint8_t row) const
+{
+    return (ram(column, row / 8) >> (row % 8)) & 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1305Emulator::displayPixel(uint8_t x, uint8_t y) const
+{
+    if (!displayOn || y > multiplexRatio)
+        return false;
+
+    if (entireDisplayOn)
+        return true;
+
+    const uint8_t panelColumns = variant == Variant::SSD1306 ? 128 : Columns;
+    const uint8_t com = comRemap ? multiplexRatio - y : y;
+
+    const uint8_t ramColumn = segmentRemap ? (panelColumns - 1 - x) : x;
+    const uint8_t ramRow = (com + startLine + displayOffset) % Rows;
+
+    return ramPixel(ramColumn, ramRow) != inverse;
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t SSD1305Emulator::numberOfParameters(uint8_t cmd) const
+{
+    switch (cmd)
+    {
+    case command::SetMemoryAddressingMode:
+    case command::SetContrastControl:
+    case command::SetBrightness:
+    case command::ChargePumpSetting:
+    case command::SetMuxRatio:
+    case command::MasterConfig:
+    case command::SetDisplayOffset:
+    case command::SetDisplayClockDivider:
+    case command::SetAreaColorMode:
+    case command::SetPrechargingPeriod:
+    case command::SetComPinsConfig:
+    case command::SetVcomhDeselectLevel:
+        return 1;
+
+    case command::SetColumnAddress:
+    case command::SetPageAddress:
+    case command::SetVerticalScrollArea:
+        return 2;
+
+    case command::DimModeSetting:
+        return 3;
+
+    case command::SetLut:
+    case command::SetBankColor1To16:
+    case command::SetBankColor17To32:
+        return 4;
+
+    case command::VerticalRightScroll:
+    case command::VerticalLeftScroll:
+        return 5;
+
+    case command::RightHorizontalScroll:
+    case command::LeftHorizontalScroll:
+        return variant == Variant::SSD1306 ? 6 : 4;
+
+    default:
+        return 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::decodeCommand(uint8_t cmd)
+{
+    isDummyReadDue = true;
+
+    if (expectedParameters > 0)
+    {
+        parameters[parameterCount++] = cmd;
+
+        if (parameterCount == expectedParameters)
+        {
+            executeCommand();
+            expectedParameters = 0;
+        }
+        return;
+    }
+
+    pendingCommand = cmd;
+    parameterCount = 0;
+    expectedParameters = numberOfParameters(cmd);
+
+    if (expectedParameters == 0)
+        executeCommand();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::executeCommand()
+{
+    const uint8_t cmd = pendingCommand;
+
+    if (cmd <= 0x0F)
+    {
+        column = (column & 0xF0) | (cmd & 0x0F);
+        return;
+    }
+
+    if (cmd <= 0x1F)
+    {
+        column = (column & 0x0F) | ((cmd & 0x0F) << 4);
+        return;
+    }
+
+    if (cmd >= command::SetDisplayStartLine && cmd <= command::SetDisplayStartLine + 0x3F)
+    {
+        startLine = cmd & 0x3F;
+        return;
+    }
+
+    if (cmd >= command::SetPageStartAddress && cmd <= command::SetPageStartAddress + 0x07)
+    {
+        page = cmd & 0x07;
+        return;
+    }
+
+    switch (cmd)
+    {
+    case command::SetMemoryAddressingMode:
+        mode = static_cast<AddressingMode>(parameters[0] & 0b11);
+        break;
+
+    case command::SetColumnAddress:
+        columnStart = parameters[0] % Columns;
+        columnEnd = parameters[1] % Columns;
+        column = columnStart;
+        break;
+
+    case command::SetPageAddress:
+        pageStart = parameters[0] % Pages;
+        pageEnd = parameters[1] % Pages;
+        page = pageStart;
+        break;
+
+    case command::RightHorizontalScroll:
+    case command::LeftHorizontalScroll:
+    case command::VerticalRightScroll:
+    case command::VerticalLeftScroll:
+        // the setup requires the scrolling to be deactivated
+        break;
+
+    case command::DeactivateScroll:
+        scrollActive = false;
+        break;
+
+    case command::ActivateScroll:
+        scrollActive = true;
+        break;
+
+    case command::SetContrastControl:
+        contrastValue = parameters[0];
+        break;
+
+    case command::SetSegmentRemap:
+    case command::SetSegmentRemap | 1:
+        segmentRemap = cmd & 1;
+        break;
+
+    case command::EntireDisplayOn:
+    case command::EntireDisplayOn | 1:
+        entireDisplayOn = cmd & 1;
+        break;
+
+    case command::SetNormalInverseDisplay:
+    case command::SetNormalInverseDisplay | 1:
+        inverse = cmd & 1;
+        break;
+
+    case command::SetMuxRatio:
+        multiplexRatio = parameters[0] & 0x3F;
+        break;
+
+    case command::SetDisplayOn:
+    case command::SetDisplayDimmed:
+        displayOn = true;
+        break;
+
+    case command::SetDisplayOff:
+        displayOn = false;
+        break;
+
+    case command::SetComOutputDirection:
+    case command::SetComOutputDirection | 0b1000:
+        comRemap = cmd & 0b1000;
+        break;
+
+    case command::SetDisplayOffset:
+        displayOffset = parameters[0] & 0x3F;
+        break;
+
+    case command::EnterReadWriteModify:
+        readModifyWrite = true;
+        savedColumn = column;
+        savedPage = page;
+        break;
+
+    case command::ExitReadWriteModify:
+        if (readModifyWrite)
+        {
+            column = savedColumn;
+            page = savedPage;
+        }
+        readModifyWrite = false;
+        break;
+
+    default:
+        // commands without influence on the GDDRAM or the visible image
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::writeRam(uint8_t data)
+{
+    if (column < Columns && page < Pages)
+        gddram[page][column] = data;
+
+    isDummyReadDue = true;
+    advancePointer();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::advancePointer()
+{
+    switch (mode)
+    {
+    case AddressingMode::Page:
+        column = (column + 1) % Columns;
+        break;
+
+    case AddressingMode::Horizontal:
+        if (column++ == columnEnd)
+        {
+            column = columnStart;
+            page = (page == pageEnd) ? pageStart : page + 1;
+        }
+        break;
+
+    case AddressingMode::Vertical:
+    default:
+        if (page++ == pageEnd)
+        {
+            page = pageStart;
+            column = (column == columnEnd) ? columnStart : column + 1;
+        }
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::recordTransaction(ByteType type, const uint8_t *data, size_t length)
+{
+    recordBytes(type, data, length, true);
+    finishTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::recordBytes(ByteType type, const uint8_t *data, size_t length,
+                                  bool isFramed)
+{
+    for (size_t i = 0; i < length; ++i)
+        byteTrace.push_back({type, data[i], transactionIndex});
+
+    size_t wireBytes = length;
+    uint64_t clockCycles = length * 8;
+
+    if (bus == Bus::I2c)
+    {
+        wireBytes += isFramed ? I2cFramingBytes : 0;
+        clockCycles = wireBytes * 9 + (isFramed ? I2cStartStopCycles : 0);
+    }
+    else if (bus == Bus::Parallel)
+    {
+        clockCycles = length;
+    }
+
+    const uint64_t transferTimeNs = clockHz == 0 ? 0 : clockCycles * 1'000'000'000 / clockHz;
+
+    for (auto *traffic : {&frameTraffic, &total})
+    {
+        if (type == ByteType::Command)
+            traffic->commandBytes += length;
+        else if (type == ByteType::Data)
+            traffic->dataBytes += length;
+        else
+            traffic->readBytes += length;
+
+        traffic->wireBytes += wireBytes;
+        traffic->transferTimeNs += transferTimeNs;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1305Emulator::finishTransaction()
+{
+    ++transactionIndex;
+    ++frameTraffic.transactions;
+    ++total.transactions;
+}
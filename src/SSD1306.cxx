@@ -1,13 +0,0 @@
-#include "ssd-display-driver/SSD1306.hpp"
-
-namespace command
-{
-constexpr auto ChargePumpSetting = 0x8D;
-}
-
-//--------------------------------------------------------------------------------------------------
-void SSD1306::setChargePump(bool enable)
-{
-    di.writeCommand(command::ChargePumpSetting);
-    di.writeCommand(enable ? 0x14 : 0x10);
-}
\ No newline at end of file
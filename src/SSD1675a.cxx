@@ -1,6 +1,9 @@
 #include "ssd-display-driver/SSD1675a.hpp"
+#include "ssd-display-driver/LutComposer.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 
 constexpr auto Width = 152;
 constexpr auto Height = 296;
@@ -84,6 +87,60 @@ constexpr std::array<uint8_t,lutSize>  Default = {
 // clang-format on
 } // namespace ssd1675a_lut
 
+namespace
+{
+constexpr auto VSS = lut_composer::Voltage::VSS;
+constexpr auto VSH1 = lut_composer::Voltage::VSH1;
+constexpr auto VSL = lut_composer::Voltage::VSL;
+constexpr auto VSH2 = lut_composer::Voltage::VSH2;
+constexpr auto Idle = lut_composer::Idle;
+
+// The hand-packed waveforms described by their phases, LUT0 to LUT4 each.
+
+constexpr std::array<lut_composer::Phase, 5> DefaultPhases = {{
+    {{{{VSS, VSL, VSS, VSL},
+       {VSS, VSH1, VSS, VSH1},
+       {VSH1, VSL, VSL, VSL},
+       {VSH1, VSL, VSL, VSL},
+       Idle}},
+     {4, 24, 4, 22},
+     1},
+    {{{{VSS, VSH1, VSS, VSH1},
+       {VSL, VSS, VSL, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {10, 10, 10, 10},
+     2},
+    {{{{VSS, VSH1, VSS, VSS},
+       {VSL, VSS, VSS, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {0, 0, 0, 0}},
+    {{{Idle, {VSL, VSS, VSS, VSS}, {VSL, VSH1, VSL, VSH2}, {VSL, VSH1, VSL, VSH2}, Idle}},
+     {0, 0, 0, 0}},
+    {{{{VSS, VSH1, VSS, VSS},
+       {VSL, VSS, VSS, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {4, 4, 8, 60},
+     7},
+}};
+
+constexpr std::array<lut_composer::Phase, 1> DeltaPhases = {{
+    {{{Idle, {VSL, VSS, VSS, VSS}, {VSH1, VSS, VSS, VSS}, Idle, Idle}}, {24, 0, 0, 0}, 1},
+}};
+
+static_assert(lut_composer::isEqual(lut_composer::composeSSD1675a(DefaultPhases),
+                                    ssd1675a_lut::Default),
+              "Default matches its phases");
+static_assert(lut_composer::isEqual(lut_composer::composeSSD1675a(DeltaPhases),
+                                    ssd1675a_lut::Delta),
+              "Delta matches its phases");
+} // namespace
+
 //--------------------------------------------------------------------------------------------------
 namespace command
 {
@@ -122,232 +179,1227 @@ constexpr auto Nop							= 0x7F;
 // clang-format on
 } // namespace command
 
+namespace
+{
+/// Auto write RAM parameter: first value in bit 7, step height in bits 6..4 and step width in
+/// bits 2..0. The largest steps exceed the panel, so the first value fills the whole RAM.
+constexpr uint8_t AutoWriteOnes = 0xF7;
+constexpr uint8_t AutoWriteZeros = 0x77;
+
+/// Constant bytes streamed per transfer by fills without auto write.
+constexpr size_t FillChunkLength = 32;
+
+/// Temperature sensor control: internal sensor, or value written by WriteTemperatureSensor.
+constexpr uint8_t InternalTemperatureSensor = 0x80;
+constexpr uint8_t ExternalTemperatureSensor = 0x48;
+
+/// Display update control 2: enable clock, load temperature, disable clock. The LUT register
+/// is left untouched.
+constexpr uint8_t LoadTemperature = 0xA1;
+
+/// Display update control 2 of the refreshes with an uploaded LUT: enable clock and analog,
+/// display with DISPLAY Mode 2, disable analog and clock.
+constexpr uint8_t DisplayMode2 = 0xCF;
+
+/// Display update control 2 of the refreshes without a selected LUT, also the reset value: like
+/// DisplayMode2, but loading the temperature and the LUT from the OTP first.
+constexpr uint8_t LoadOtpLutAndDisplay = 0xFF;
+
+/// Rows per band when expanding compressed planes.
+constexpr uint16_t CompressedBandRows = 8;
+
+/// Decoders of both planes for submitCompressedPlanes().
+struct PlaneDecoders
+{
+    image_compression::Decoder bw;
+    image_compression::Decoder red;
+    uint8_t bwBlank;  //!< White in the BW RAM polarity.
+    uint8_t redBlank; //!< Not red in the red RAM polarity.
+};
+
+/// BandRenderer expanding compressed planes, missing data is left white and not red.
+void decodeBand(void *context, uint16_t, uint16_t rows, uint8_t *bwBand, uint8_t *redBand)
+{
+    auto &decoders = *static_cast<PlaneDecoders *>(context);
+    const size_t length = rows * (Width / 8);
+
+    const size_t bwLength = decoders.bw.decode(bwBand, length);
+    std::memset(bwBand + bwLength, decoders.bwBlank, length - bwLength);
+
+    if (redBand != nullptr)
+    {
+        const size_t redLength = decoders.red.decode(redBand, length);
+        std::memset(redBand + redLength, decoders.redBlank, length - redLength);
+    }
+}
+} // namespace
+
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::init()
 {
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Init);
+
     // readCalibration();
 
-    interface.waitUntilIdle();
+    if (!startInit())
+        return;
+
+    // same steps as the non-blocking API, but waiting on the busy pin in between
+    while (operation != Operation::None)
+    {
+        waitUntilIdle();
+
+        if (advanceOperation())
+            completeOperation();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::startInit()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Init);
+
+    if (operation != Operation::None)
+        return false;
+
+    // the reset is issued by poll() as soon as the controller is idle
+    operation = Operation::Init;
+    operationStep = 0;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::startReset()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Init);
+
+    if (operation != Operation::None)
+        return false;
+
     softwareReset();
-    interface.waitUntilIdle();
+    operation = Operation::Reset;
+    return true;
+}
 
-    setDataEntryMode(0b001);
-    setDisplayUpdateControl1(RamOption::Normal, RamOption::Inverse, false);
-    setDriverOutput(Height & 0xFF, (Height & 0x100) >> 8, 0x00);
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::startLoadLut()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::LutUpload);
 
-    setBorderWaveform(0x80);
+    if (operation != Operation::None)
+        return false;
 
-    if (lutSelection != LutSelection::None)
+    writeLut();
+    operation = Operation::LoadLut;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::startRefresh()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Refresh);
+
+    if (operation != Operation::None)
+        return false;
+
+    masterActivation();
+    operation = Operation::Refresh;
+    operationStep = 1;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::startRefresh(LutSelection selection)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Refresh);
+
+    if (operation != Operation::None)
+        return false;
+
+    lutSelection = selection;
+    operation = Operation::Refresh;
+    operationStep = 0;
+
+    // without an upload to wait for, the activation can be issued right away
+    if (!writeLut())
+        advanceOperation();
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::poll()
+{
+    if (operation == Operation::None)
+        return true;
+
+    flushTransaction();
+
+    if (interface.isBusy())
+        return false;
+
+    SSD_INSTRUMENT_OPERATION(
+        operation == Operation::Refresh   ? instrumentation::Operation::Refresh
+        : operation == Operation::LoadLut ? instrumentation::Operation::LutUpload
+                                          : instrumentation::Operation::Init);
+
+    if (advanceOperation())
+        completeOperation();
+
+    return operation == Operation::None;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::advanceOperation()
+{
+    if (operation == Operation::Refresh && operationStep == 0)
     {
-        loadLut();
-        interface.writeCommand(0x22); // Display Update Control 2
-        interface.writeData(
-            0xCF); // Enable clock signal, Analog, Display with DISPLAY Mode 2, Disable Analog, OSC
+        // the LUT has been uploaded
+        setRefreshSequence();
+        masterActivation();
+        operationStep = 1;
+        return false;
+    }
+
+    if (operation != Operation::Init)
+        return true;
+
+    switch (operationStep++)
+    {
+    case 0:
+        softwareReset();
+        return false;
+
+    case 1:
+        beginTransaction();
+
+        setDataEntryMode(0b001);
+        setDisplayUpdateControl1(RamOption::Normal, RamOption::Inverse, false);
+        setDriverOutput(Height & 0xFF, (Height & 0x100) >> 8, 0x00);
+
+        setBorderWaveform(0x80);
+
+        endTransaction();
+
+        return !writeLut();
+
+    default:
+        setRefreshSequence();
+        return true;
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::completeOperation()
+{
+    operation = Operation::None;
+
+    // the callback may start the next operation and set a new callback
+    const auto callback = operationCallback;
+    operationCallback = nullptr;
+
+    if (callback != nullptr)
+        callback(operationContext);
+}
+
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDriverOutput(uint8_t value1, uint8_t value2, uint8_t value3)
 {
-    interface.writeCommand(command::DriverOutput);
-    interface.writeData(value1); // MUX gate lines
-    interface.writeData(value2); // MUX gate lines
-    interface.writeData(value3); // Gate scanning sequence and direction
+    writeCommand(command::DriverOutput);
+    writeData(value1); // MUX gate lines
+    writeData(value2); // MUX gate lines
+    writeData(value3); // Gate scanning sequence and direction
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setSourceDrivingVoltage(uint8_t value1, uint8_t value2, uint8_t value3)
 {
-    interface.writeCommand(command::SourceDrivingVoltage);
-    interface.writeData(value1);
-    interface.writeData(value2);
-    interface.writeData(value3);
+    writeCommand(command::SourceDrivingVoltage);
+    writeData(value1);
+    writeData(value2);
+    writeData(value3);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::deepSleep(uint8_t mode)
 {
-    interface.writeCommand(command::DeepSleep);
-    interface.writeData(mode);
+    // the LUT register is not retained, the RAM depending on the mode
+    lutInController = LutSelection::None;
+    isPreviousImageLoaded = false;
+
+    writeCommand(command::DeepSleep);
+    writeData(mode);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDataEntryMode(uint8_t value)
 {
-    interface.writeCommand(command::DataEntryMode);
-    interface.writeData(value);
+    dataEntryMode = value;
+
+    writeCommand(command::DataEntryMode);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::softwareReset()
 {
-    interface.writeCommand(command::SoftwareReset);
+    lutInController = LutSelection::None;
+    displayUpdateControl2 = LoadOtpLutAndDisplay;
+
+    writeCommand(command::SoftwareReset);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::masterActivation()
 {
-    interface.writeCommand(command::MasterActivation);
+    writeCommand(command::MasterActivation);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDisplayUpdateControl1(RamOption redRamOption, RamOption blackRamOption,
                                         bool outputMode)
 {
-    uint8_t value = static_cast<uint8_t>(redRamOption) << 4;
-    value |= static_cast<uint8_t>(blackRamOption);
+    this->redRamOption = redRamOption;
+    this->blackRamOption = blackRamOption;
+    this->outputMode = outputMode;
 
-    interface.writeCommand(command::DisplayUpdateControl1);
-    interface.writeData(value);
-    interface.writeData((outputMode & 0x1) << 7);
+    writeDisplayUpdateControl1(redRamOption, blackRamOption, outputMode);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writeDisplayUpdateControl1(RamOption redOption, RamOption blackOption, bool output)
+{
+    uint8_t value = static_cast<uint8_t>(redOption) << 4;
+    value |= static_cast<uint8_t>(blackOption);
+
+    writeCommand(command::DisplayUpdateControl1);
+    writeData(value);
+    writeData((output & 0x1) << 7);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDisplayUpdateControl2(uint8_t value)
 {
-    interface.writeCommand(command::DisplayUpdateControl2);
-    interface.writeData(value);
+    displayUpdateControl2 = value;
+
+    writeCommand(command::DisplayUpdateControl2);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::writeVcomRegister(uint8_t value)
 {
-    interface.writeCommand(command::WriteVcomRegister);
-    interface.writeData(value);
+    writeCommand(command::WriteVcomRegister);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::loadLut()
 {
-    using namespace ssd1675a_lut;
+    if (writeLut())
+        waitUntilIdle();
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::writeLut()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::LutUpload);
 
     if (lutSelection == LutSelection::None)
-        return;
+        return false;
+
+    if (lutSelection == lutInController)
+    {
+        ++lutCounters.skippedUploads;
+        return false;
+    }
 
-    interface.writeCommand(command::WriteLUTRegister);
+    const size_t length = lutLayout().size;
+
+    beginTransaction();
+    writeCommand(command::WriteLUTRegister);
+    appendData(lutData(lutSelection), length);
+    endTransaction();
+
+    lutInController = lutSelection;
+    ++lutCounters.uploads;
+    lutCounters.uploadedBytes += length;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+const uint8_t *SSD1675a::lutData(LutSelection selection) const
+{
+    using namespace ssd1675a_lut;
 
-    switch (lutSelection)
+    switch (selection)
     {
     case LutSelection::BlackWhite:
-        interface.writeData(reinterpret_cast<const uint8_t *>(BlackWhite.data()), lutSize);
-        break;
+        return BlackWhite.data();
 
     case LutSelection::Delta:
-        interface.writeData(reinterpret_cast<const uint8_t *>(Delta.data()), lutSize);
-        break;
+        return Delta.data();
 
     case LutSelection::Red:
         // return ssd1675a_lut::Red;
-        // break;
     case LutSelection::Default:
     default:
-        interface.writeData(reinterpret_cast<const uint8_t *>(Default.data()), lutSize);
-        break;
+        return Default.data();
     }
+}
 
-    interface.waitUntilIdle();
+//--------------------------------------------------------------------------------------------------
+const lut_timing::Layout &SSD1675a::lutLayout() const
+{
+    return lut_timing::SSD1675a;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint64_t SSD1675a::lutDurationUs(LutSelection selection) const
+{
+    if (selection == LutSelection::None)
+        return 0;
+
+    return lut_timing::durationUs(lutData(selection), lutLayout());
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::readTemperature(int8_t &celsius)
+{
+    const uint8_t sequence = displayUpdateControl2;
+
+    beginTransaction();
+    writeCommand(command::TemperatureSensorControl);
+    writeData(InternalTemperatureSensor);
+    setDisplayUpdateControl2(LoadTemperature);
+    endTransaction();
+
+    masterActivation();
+    waitUntilIdle();
+
+    // the following activations refresh the display again
+    beginTransaction();
+    setDisplayUpdateControl2(sequence);
+    writeCommand(command::ReadTemperatureSensor);
+    endTransaction();
+
+    // 12 bit two's complement in 1/16 °C, MSB first
+    uint8_t value[2];
+    if (!interface.readData(value, sizeof(value)))
+        return false;
+
+    celsius = static_cast<int8_t>(value[0]);
+    lastTemperature = celsius;
+    isTemperatureExternal = false;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::setTemperature(int8_t celsius)
+{
+    beginTransaction();
+    writeCommand(command::TemperatureSensorControl);
+    writeData(ExternalTemperatureSensor);
+    writeCommand(command::WriteTemperatureSensor);
+    writeData(static_cast<uint8_t>(celsius));
+    writeData(0x00);
+    endTransaction();
+
+    lastTemperature = celsius;
+    isTemperatureExternal = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+SSD1675a::LutSelection SSD1675a::selectLutForTemperature(int8_t celsius)
+{
+    const WaveformBand *selectedBand = nullptr;
+    uint64_t shortestDuration = UINT64_MAX;
+
+    for (size_t i = 0; i < numberOfWaveformBands; ++i)
+    {
+        const auto &band = waveformBands[i];
+
+        if (celsius < band.minTemperature || celsius > band.maxTemperature)
+            continue;
+
+        const uint64_t duration = lutDurationUs(band.lut);
+
+        if (duration < shortestDuration)
+        {
+            selectedBand = &band;
+            shortestDuration = duration;
+        }
+    }
+
+    if (selectedBand == nullptr || selectedBand->lut == LutSelection::None)
+        return LutSelection::None;
+
+    fullRefreshLut = selectedBand->lut;
+    partialRefreshLut = selectedBand->partialLut == LutSelection::None ? LutSelection::Delta
+                                                                       : selectedBand->partialLut;
+
+    selectLut(selectedBand->lut);
+    loadLut();
+
+    return selectedBand->lut;
+}
+
+//--------------------------------------------------------------------------------------------------
+SSD1675a::LutSelection SSD1675a::updateWaveform()
+{
+    int8_t celsius = lastTemperature;
+
+    if (!isTemperatureExternal && !readTemperature(celsius))
+        return LutSelection::None;
+
+    return selectLutForTemperature(celsius);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setBorderWaveform(uint8_t value)
 {
-    interface.writeCommand(command::BorderWaveform);
-    interface.writeData(value);
+    writeCommand(command::BorderWaveform);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setXStartEnd(uint8_t start, uint8_t end)
 {
-    interface.writeCommand(command::RamXStartEndPos);
-    interface.writeData(start);
-    interface.writeData(end);
+    writeCommand(command::RamXStartEndPos);
+    writeData(start);
+    writeData(end);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setYStartEnd(uint16_t start, uint16_t end)
 {
-    interface.writeCommand(command::RamYStartEndPos);
-    interface.writeData(start & 0xFF);
-    interface.writeData(start >> 8);
-    interface.writeData(end & 0xFF);
-    interface.writeData(end >> 8);
+    writeCommand(command::RamYStartEndPos);
+    writeData(start & 0xFF);
+    writeData(start >> 8);
+    writeData(end & 0xFF);
+    writeData(end >> 8);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setAddressCounter(uint8_t x, const uint16_t y)
 {
-    interface.writeCommand(command::RamXCounter);
-    interface.writeData(x);
+    writeCommand(command::RamXCounter);
+    writeData(x);
 
-    interface.writeCommand(command::RamYCounter);
-    interface.writeData(y & 0xFF);
-    interface.writeData(y >> 8);
+    writeCommand(command::RamYCounter);
+    writeData(y & 0xFF);
+    writeData(y >> 8);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::nop()
 {
-    interface.writeCommand(command::Nop);
+    writeCommand(command::Nop);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setAnalogBlock(uint8_t value)
 {
-    interface.writeCommand(command::AnalogBlock);
-    interface.writeData(value);
+    writeCommand(command::AnalogBlock);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDigitalBlock(uint8_t value)
 {
-    interface.writeCommand(command::DigitalBlock);
-    interface.writeData(value);
+    writeCommand(command::DigitalBlock);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setDummyLinePeriod(uint8_t value)
 {
-    interface.writeCommand(command::DummyLinePeriod);
-    interface.writeData(value);
+    writeCommand(command::DummyLinePeriod);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::setGateLineWidth(uint8_t value)
 {
-    interface.writeCommand(command::GateLineWidth);
-    interface.writeData(value);
+    writeCommand(command::GateLineWidth);
+    writeData(value);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::draw(uint8_t data)
 {
+    flushTransaction();
     interface.writeData(data);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::draw(const uint8_t *data, size_t length)
 {
-    interface.writeData(data, length);
+    writeData(data, length);
 }
 
 //--------------------------------------------------------------------------------------------------
 void SSD1675a::submitImage(const uint8_t *image, size_t length)
 {
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
     if (length == 0)
     {
         masterActivation();
-        interface.waitUntilIdle();
+        waitUntilIdle();
     }
     else if ((length >> 24) & 0x1)
     {
         // Bit 24 is set -> black ram
-        interface.writeCommand(command::WriteBWRam);
-        draw(image, length & 0xFFFF);
+        writePlane(Plane::BlackWhite, image, length & 0xFFFF);
     }
     else if ((length >> 26) & 0x1)
     {
         // Bit 26 is set -> red ram
-        interface.writeCommand(command::WriteRedRam);
-        draw(image, length & 0xFFFF);
+        writePlane(Plane::Red, image, length & 0xFFFF);
     }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writePlane(Plane plane, const uint8_t *image, size_t length)
+{
+    trackPlaneWrite(plane);
+
+    writeCommand(plane == Plane::Red ? command::WriteRedRam : command::WriteBWRam);
+    draw(image, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::appendPlane(Plane plane, const uint8_t *image, size_t length)
+{
+    trackPlaneWrite(plane);
+
+    writeCommand(plane == Plane::Red ? command::WriteRedRam : command::WriteBWRam);
+    appendData(image, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::submitPlanes(const uint8_t *bwImage, const uint8_t *redImage,
+                            size_t planeLength, bool activate)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    constexpr uint8_t XEnd = (Width / 8) - 1;
+    constexpr uint16_t YEnd = Height - 1;
+
+    // the red RAM keeps holding the shown image for partialRefresh()
+    const bool isPreviousImage =
+        isRedRamPreviousImage && bwImage != nullptr && redImage == nullptr && activate;
+
+    beginTransaction();
+    setRamWindow(0, XEnd, 0, YEnd);
+
+    if (bwImage != nullptr)
+        appendPlane(Plane::BlackWhite, bwImage, planeLength);
+
+    if (redImage != nullptr)
+    {
+        if (bwImage != nullptr)
+            resetAddressCounter(0, XEnd, 0, YEnd);
+
+        appendPlane(Plane::Red, redImage, planeLength);
+    }
+
+    if (isPreviousImage)
+    {
+        resetAddressCounter(0, XEnd, 0, YEnd);
+        writeCommand(command::WriteRedRam);
+        appendData(bwImage, planeLength);
+    }
+
+    endTransaction();
+
+    if (!activate)
+        return;
+
+    if (isPreviousImage)
+        writeDisplayUpdateControl1(RamOption::Bypass, blackRamOption, outputMode);
+
+    masterActivation();
+    waitUntilIdle();
+
+    if (isPreviousImage)
+    {
+        writeDisplayUpdateControl1(redRamOption, blackRamOption, outputMode);
+        isPreviousImageLoaded = true;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::submitPlanes(const uint8_t *bwImage, const uint8_t *redImage,
+                            const Window &window, bool activate)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    const Window aligned = alignWindow(window);
+
+    if (aligned.width == 0 || aligned.height == 0)
+        return;
+
+    const uint8_t xStart = aligned.x / 8;
+    const uint8_t xEnd = ((aligned.x + aligned.width) / 8) - 1;
+    const uint16_t yEnd = aligned.y + aligned.height - 1;
+    const size_t planeLength = size_t{xEnd - xStart + 1u} * aligned.height;
+
+    beginTransaction();
+    setRamWindow(xStart, xEnd, aligned.y, yEnd);
+
+    if (bwImage != nullptr)
+        appendPlane(Plane::BlackWhite, bwImage, planeLength);
+
+    if (redImage != nullptr)
+    {
+        if (bwImage != nullptr)
+            resetAddressCounter(xStart, xEnd, aligned.y, yEnd);
+
+        appendPlane(Plane::Red, redImage, planeLength);
+    }
+
+    setRamWindow(0, (Width / 8) - 1, 0, Height - 1);
+    endTransaction();
+
+    if (activate)
+    {
+        masterActivation();
+        waitUntilIdle();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::submitStreamedPlanes(BandRenderer renderer, void *context, uint8_t *bwBand,
+                                    uint8_t *redBand, uint16_t bandRows, bool activate)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    constexpr uint8_t XEnd = (Width / 8) - 1;
+    constexpr uint16_t YEnd = Height - 1;
+    constexpr size_t BytesPerRow = Width / 8;
+
+    if (bandRows == 0)
+        return;
+
+    const bool isYIncrement = dataEntryMode & 0b10;
+
+    beginTransaction();
+    setRamWindow(0, XEnd, 0, YEnd);
+
+    for (uint16_t firstRow = 0; firstRow < Height; firstRow += bandRows)
+    {
+        const uint16_t rows = std::min<uint16_t>(bandRows, Height - firstRow);
+        const uint16_t lastRow = firstRow + rows - 1;
+
+        renderer(context, firstRow, rows, bwBand, redBand);
+
+        // RAM rows of the band, image rows are counted downwards when decrementing Y
+        const uint16_t yStart = isYIncrement ? firstRow : YEnd - lastRow;
+        const uint16_t yEnd = isYIncrement ? lastRow : YEnd - firstRow;
+
+        resetAddressCounter(0, XEnd, yStart, yEnd);
+        writePlane(Plane::BlackWhite, bwBand, rows * BytesPerRow);
+
+        if (redBand != nullptr)
+        {
+            resetAddressCounter(0, XEnd, yStart, yEnd);
+            writePlane(Plane::Red, redBand, rows * BytesPerRow);
+        }
+    }
+
+    endTransaction();
+
+    if (activate)
+    {
+        masterActivation();
+        waitUntilIdle();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::submitCompressedPlanes(const uint8_t *bwData, size_t bwLength,
+                                      const uint8_t *redData, size_t redLength, bool activate)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    std::array<uint8_t, CompressedBandRows *(Width / 8)> bwBand;
+    std::array<uint8_t, CompressedBandRows *(Width / 8)> redBand;
+
+    const auto format = planeFormat();
+    PlaneDecoders decoders{{bwData, bwLength},
+                           {redData, redLength},
+                           static_cast<uint8_t>(format.invertBlack ? 0x00 : 0xFF),
+                           static_cast<uint8_t>(format.invertRed ? 0xFF : 0x00)};
+
+    submitStreamedPlanes(decodeBand, &decoders, bwBand.data(),
+                         redData != nullptr ? redBand.data() : nullptr, CompressedBandRows,
+                         activate);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::fillPlane(Plane plane, uint8_t value)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    trackPlaneWrite(plane);
+
+    if (value == 0x00 || value == 0xFF)
+    {
+        writeCommand(plane == Plane::Red ? command::AutoWriteRedRam : command::AutoWriteBWRam);
+        writeData(value == 0xFF ? AutoWriteOnes : AutoWriteZeros);
+
+        // busy while the controller writes the pattern
+        waitUntilIdle();
+        return;
+    }
+
+    fillPlane(plane, value, Window{0, 0, Width, Height});
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::fillPlane(Plane plane, uint8_t value, const Window &window)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    const Window aligned = alignWindow(window);
+
+    if (aligned.width == 0 || aligned.height == 0)
+        return;
+
+    trackPlaneWrite(plane);
+
+    const uint8_t xStart = aligned.x / 8;
+    const uint8_t xEnd = ((aligned.x + aligned.width) / 8) - 1;
+    const uint16_t yEnd = aligned.y + aligned.height - 1;
+    size_t remaining = size_t{xEnd - xStart + 1u} * aligned.height;
+
+    std::array<uint8_t, FillChunkLength> chunk;
+    chunk.fill(value);
+
+    beginTransaction();
+    setRamWindow(xStart, xEnd, aligned.y, yEnd);
+    writeCommand(plane == Plane::Red ? command::WriteRedRam : command::WriteBWRam);
+
+    while (remaining > 0)
+    {
+        const size_t length = std::min(remaining, chunk.size());
+        draw(chunk.data(), length);
+        remaining -= length;
+    }
+
+    setRamWindow(0, (Width / 8) - 1, 0, Height - 1);
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::clearPlanes()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    const auto format = planeFormat();
+
+    fillPlane(Plane::BlackWhite, format.invertBlack ? 0x00 : 0xFF);
+    fillPlane(Plane::Red, format.invertRed ? 0xFF : 0x00);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::submitImageAsync(const uint8_t *image, size_t length)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::SubmitImage);
+
+    uint8_t ramCommand = 0;
+
+    if ((length >> 24) & 0x1)
+        ramCommand = command::WriteBWRam;
+
+    else if ((length >> 26) & 0x1)
+        ramCommand = command::WriteRedRam;
+
+    if (asyncInterface == nullptr || length == 0 || ramCommand == 0)
+    {
+        submitImage(image, length);
+        return;
+    }
+
+    trackPlaneWrite(ramCommand == command::WriteRedRam ? Plane::Red : Plane::BlackWhite);
+    writeCommand(ramCommand);
+    flushTransaction();
+
+    isImageTransferRunning = true;
+    asyncInterface->startWriteData(image, length & 0xFFFF);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::isImageTransferComplete()
+{
+    if (isImageTransferRunning && asyncInterface->isTransferComplete())
+        isImageTransferRunning = false;
+
+    return !isImageTransferRunning;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::waitForImageTransfer()
+{
+    if (!isImageTransferRunning)
+        return;
+
+    asyncInterface->waitForTransfer();
+    isImageTransferRunning = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+SSD1675a::Window SSD1675a::alignWindow(const Window &window)
+{
+    Window aligned{};
+
+    if (window.x >= Width || window.y >= Height)
+        return aligned;
+
+    const uint16_t xEnd = std::min<uint16_t>(window.x + window.width, Width);
+    const uint16_t yEnd = std::min<uint16_t>(window.y + window.height, Height);
+
+    aligned.x = window.x & ~0x7;
+    aligned.y = window.y;
+    aligned.width = std::min<uint16_t>((xEnd + 7) & ~0x7, Width) - aligned.x;
+    aligned.height = yEnd - window.y;
+
+    return aligned;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::partialRefresh(const uint8_t *image, const Window &window)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Refresh);
+
+    const Window aligned = alignWindow(window);
+
+    if (aligned.width == 0 || aligned.height == 0)
+        return;
+
+    // without the shown image in the red RAM, the pixels outside the window would be driven
+    const bool isFullRefreshDue = countPartialRefresh(aligned) || !isPreviousImageLoaded;
+
+    writeWindow(command::WriteBWRam, image, aligned);
+
+    if (isFullRefreshDue)
+        fullRefresh();
+    else
+    {
+        // the LUT is selected by the previous (red RAM) and the new color (BW RAM) of a pixel,
+        // so both have to be read with the same polarity
+        writeDisplayUpdateControl1(blackRamOption, blackRamOption, outputMode);
+        refreshWithLut(partialRefreshLut);
+        writeDisplayUpdateControl1(redRamOption, blackRamOption, outputMode);
+    }
+
+    // the new image becomes the previous image for the next Delta refresh
+    writeWindow(command::WriteRedRam, image, aligned);
+    isRedRamPreviousImage = true;
+
+    setRamWindow(0, (Width / 8) - 1, 0, Height - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::fullRefresh()
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Refresh);
+
+    writeDisplayUpdateControl1(RamOption::Bypass, blackRamOption, outputMode);
+    refreshWithLut(fullRefreshLut);
+    writeDisplayUpdateControl1(redRamOption, blackRamOption, outputMode);
+
+    regionRefreshCounts.fill(0);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::fullRefresh(const uint8_t *image, size_t planeLength)
+{
+    submitPlanes(image, image, planeLength, false);
+    fullRefresh();
+
+    isRedRamPreviousImage = true;
+    isPreviousImageLoaded = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::trackPlaneWrite(Plane plane)
+{
+    // the shown image is no longer known, and red content must not be overwritten
+    isPreviousImageLoaded = false;
+
+    if (plane == Plane::Red)
+        isRedRamPreviousImage = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::setRefreshSequence()
+{
+    if (lutSelection != LutSelection::None)
+    {
+        setDisplayUpdateControl2(DisplayMode2);
+        return;
+    }
+
+    // the LUT register is overwritten from the OTP
+    lutInController = LutSelection::None;
+    setDisplayUpdateControl2(LoadOtpLutAndDisplay);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::setRamWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd)
+{
+    const bool isXIncrement = dataEntryMode & 0b01;
+    const bool isYIncrement = dataEntryMode & 0b10;
+
+    // the start position is the first one to be written, so it swaps with the end
+    // position when counting downwards
+    if (isXIncrement)
+        setXStartEnd(xStart, xEnd);
+    else
+        setXStartEnd(xEnd, xStart);
+
+    if (isYIncrement)
+        setYStartEnd(yStart, yEnd);
+    else
+        setYStartEnd(yEnd, yStart);
+
+    resetAddressCounter(xStart, xEnd, yStart, yEnd);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::resetAddressCounter(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd)
+{
+    const bool isXIncrement = dataEntryMode & 0b01;
+    const bool isYIncrement = dataEntryMode & 0b10;
+
+    setAddressCounter(isXIncrement ? xStart : xEnd, isYIncrement ? yStart : yEnd);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writeWindow(uint8_t ramCommand, const uint8_t *image, const Window &window)
+{
+    const uint8_t xStart = window.x / 8;
+    const uint8_t xEnd = ((window.x + window.width) / 8) - 1;
+
+    beginTransaction();
+    setRamWindow(xStart, xEnd, window.y, window.y + window.height - 1);
+
+    writeCommand(ramCommand);
+    appendData(image, (xEnd - xStart + 1) * window.height);
+    endTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675a::countPartialRefresh(const Window &window)
+{
+    const auto firstColumn = window.x * RegionColumns / Width;
+    const auto lastColumn = (window.x + window.width - 1) * RegionColumns / Width;
+    const auto firstRow = window.y * RegionRows / Height;
+    const auto lastRow = (window.y + window.height - 1) * RegionRows / Height;
+
+    bool isBudgetExceeded = false;
+
+    for (auto row = firstRow; row <= lastRow; ++row)
+    {
+        for (auto column = firstColumn; column <= lastColumn; ++column)
+        {
+            auto &count = regionRefreshCounts[row * RegionColumns + column];
+
+            if (count < UINT8_MAX)
+                ++count;
+
+            if (count > ghostingBudget)
+                isBudgetExceeded = true;
+        }
+    }
+
+    return isBudgetExceeded;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::refreshWithLut(LutSelection selection)
+{
+    SSD_INSTRUMENT_OPERATION(instrumentation::Operation::Refresh);
+
+    lutSelection = selection;
+    loadLut();
+
+    setRefreshSequence();
+    masterActivation();
+    waitUntilIdle();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::beginTransaction()
+{
+    ++transactionDepth;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::endTransaction()
+{
+    if (transactionDepth == 0)
+        return;
+
+    if (--transactionDepth == 0)
+        flushTransaction();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writeCommand(uint8_t cmd)
+{
+    if (transactionDepth == 0)
+    {
+        waitForImageTransfer();
+        interface.writeCommand(cmd);
+        return;
+    }
+
+    if (transactionLength + 2 > transactionBuffer.size())
+        flushTransaction();
+
+    recordStart = transactionLength;
+    isRecordBypassed = false;
+
+    transactionBuffer[transactionLength++] = cmd;
+    transactionBuffer[transactionLength++] = 0; // number of parameters
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writeData(uint8_t data)
+{
+    if (transactionDepth == 0 || isRecordBypassed)
+    {
+        waitForImageTransfer();
+        interface.writeData(data);
+        return;
+    }
+
+    if (recordStart == NoRecord)
+    {
+        // parameter without preceding command in this transaction,
+        // keep order by sending everything collected so far
+        flushTransaction();
+        interface.writeData(data);
+        return;
+    }
+
+    if (transactionLength == transactionBuffer.size())
+    {
+        if (recordStart == 0)
+        {
+            // the record fills the whole buffer, remaining parameters bypass it
+            flushTransaction();
+            isRecordBypassed = true;
+            interface.writeData(data);
+            return;
+        }
+
+        // send the complete records and move the current one to the front
+        waitForImageTransfer();
+        sendRecords(recordStart);
+
+        const size_t recordLength = transactionLength - recordStart;
+        std::copy_n(transactionBuffer.begin() + recordStart, recordLength,
+                    transactionBuffer.begin());
+        transactionLength = recordLength;
+        recordStart = 0;
+    }
+
+    transactionBuffer[transactionLength++] = data;
+    ++transactionBuffer[recordStart + 1];
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::writeData(const uint8_t *data, size_t length)
+{
+    flushTransaction();
+    interface.writeData(data, length);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::appendData(const uint8_t *data, size_t length)
+{
+    if (transactionDepth == 0)
+    {
+        writeData(data, length);
+        return;
+    }
+
+    // the records collected since the last segment precede the data
+    appendRecordSegments(transactionLength);
+    appendSegment(SSDInterface::Segment::Type::Data, data, length);
+
+    // following parameters must not be added to a record sent before the data
+    recordStart = NoRecord;
+    isRecordBypassed = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::appendSegment(SSDInterface::Segment::Type type, const uint8_t *data, size_t length)
+{
+    if (length == 0)
+        return;
+
+    if (numberOfSegments == segments.size())
+    {
+        waitForImageTransfer();
+        interface.writeSegments(segments.data(), numberOfSegments);
+        numberOfSegments = 0;
+    }
+
+    segments[numberOfSegments++] = {type, data, length};
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::appendRecordSegments(size_t end)
+{
+    for (size_t i = segmentedLength; i + 1 < end; i += 2 + transactionBuffer[i + 1])
+    {
+        appendSegment(SSDInterface::Segment::Type::Command, &transactionBuffer[i], 1);
+        appendSegment(SSDInterface::Segment::Type::Data, &transactionBuffer[i + 2],
+                      transactionBuffer[i + 1]);
+    }
+
+    segmentedLength = end;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::sendRecords(size_t end)
+{
+    if (numberOfSegments == 0)
+    {
+        // records before segmentedLength went out with segments already
+        if (end > segmentedLength)
+            interface.writeCommandSequence(transactionBuffer.data() + segmentedLength,
+                                           end - segmentedLength);
+    }
+    else
+    {
+        appendRecordSegments(end);
+        interface.writeSegments(segments.data(), numberOfSegments);
+        numberOfSegments = 0;
+    }
+
+    segmentedLength = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::waitUntilIdle()
+{
+    flushTransaction();
+    interface.waitUntilIdle();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675a::flushTransaction()
+{
+    waitForImageTransfer();
+    sendRecords(transactionLength);
+
+    transactionLength = 0;
+    recordStart = NoRecord;
 }
\ No newline at end of file
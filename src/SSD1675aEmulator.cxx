@@ -0,0 +1,473 @@
+#include "ssd-display-driver/SSD1675aEmulator.hpp"
+
+namespace command
+{
+// clang-format off
+constexpr auto DeepSleep 					= 0x10;
+constexpr auto DataEntryMode	 			= 0x11;
+constexpr auto SoftwareReset 				= 0x12;
+constexpr auto TemperatureSensorControl		= 0x18;
+constexpr auto WriteTemperatureSensor		= 0x1A;
+constexpr auto ReadTemperatureSensor		= 0x1B;
+constexpr auto MasterActivation			 	= 0x20;
+constexpr auto DisplayUpdateControl1 		= 0x21;
+constexpr auto DisplayUpdateControl2 		= 0x22;
+constexpr auto WriteBWRam 					= 0x24;
+constexpr auto WriteRedRam			 	    = 0x26;
+constexpr auto WriteLUTRegister 			= 0x32;
+constexpr auto AutoWriteRedRam 				= 0x46;
+constexpr auto AutoWriteBWRam 				= 0x47;
+constexpr auto RamXStartEndPos				= 0x44;
+constexpr auto RamYStartEndPos				= 0x45;
+constexpr auto RamXCounter 					= 0x4E;
+constexpr auto RamYCounter 					= 0x4F;
+// clang-format on
+} // namespace command
+
+namespace
+{
+constexpr uint8_t RamOptionBypass = 0b100;
+constexpr uint8_t RamOptionInverse = 0b1000;
+
+constexpr uint8_t InternalTemperatureSensor = 0x80;
+
+/// Display update control 2 sequence bits.
+constexpr uint8_t UpdateLoadTemperature = 0x20;
+constexpr uint8_t UpdateLoadLut = 0x10;
+constexpr uint8_t UpdateDisplay = 0x04;
+
+/// Applies a RAM option of display update control 1 to a RAM bit.
+bool applyRamOption(bool bit, uint8_t option)
+{
+    if (option & RamOptionBypass)
+        return false;
+
+    return (option & RamOptionInverse) ? !bit : bit;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+SSD1675aEmulator::SSD1675aEmulator(Variant variant, uint16_t width, uint16_t height)
+    : variant(variant),
+      layout(variant == Variant::SSD1680 ? lut_timing::SSD1680 : lut_timing::SSD1675a),
+      width(width), height(height), bytesPerRow((width + 7) / 8)
+{
+    const size_t planeSize = size_t{bytesPerRow} * height;
+
+    bwPlane.assign(planeSize, 0xFF);
+    redPlane.assign(planeSize, 0);
+    panelBw.assign(planeSize, 0xFF);
+    panelRed.assign(planeSize, 0);
+
+    resetRegisters();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::writeCommand(uint8_t cmd)
+{
+    recordTransaction(1, 0);
+    startCommand(cmd);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::writeCommandSequence(const uint8_t *sequence, size_t length)
+{
+    size_t commandBytes = 0;
+    size_t i = 0;
+
+    while (i + 1 < length)
+    {
+        startCommand(sequence[i]);
+        ++commandBytes;
+
+        size_t numberOfParameters = sequence[i + 1];
+        i += 2;
+
+        for (; numberOfParameters > 0 && i < length; --numberOfParameters, ++i)
+            applyParameter(sequence[i]);
+    }
+
+    recordTransaction(commandBytes, length - 2 * commandBytes);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::writeData(uint8_t data)
+{
+    recordTransaction(0, 1);
+    applyParameter(data);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::writeData(const uint8_t *data, size_t length)
+{
+    recordTransaction(0, length);
+
+    for (size_t i = 0; i < length; ++i)
+        applyParameter(data[i]);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675aEmulator::readData(uint8_t *data, size_t length)
+{
+    if (currentCommand != command::ReadTemperatureSensor)
+        return false;
+
+    recordTransaction(0, length);
+
+    // 12 bit two's complement, MSB first and left aligned
+    const uint16_t value = static_cast<uint16_t>(temperatureValue) << 4;
+    for (size_t i = 0; i < length; ++i)
+        data[i] = i < 2 ? value >> (8 * (1 - i)) : 0;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::waitUntilIdle()
+{
+    if (nowNs < busyUntilNs)
+        nowNs = busyUntilNs;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675aEmulator::isBusy()
+{
+    return nowNs < busyUntilNs;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t SSD1675aEmulator::bwRam(uint16_t xByte, uint16_t y) const
+{
+    if (xByte >= bytesPerRow || y >= height)
+        return 0;
+
+    return bwPlane[size_t{y} * bytesPerRow + xByte];
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t SSD1675aEmulator::redRam(uint16_t xByte, uint16_t y) const
+{
+    if (xByte >= bytesPerRow || y >= height)
+        return 0;
+
+    return redPlane[size_t{y} * bytesPerRow + xByte];
+}
+
+//--------------------------------------------------------------------------------------------------
+SSD1675aEmulator::Color SSD1675aEmulator::displayPixel(uint16_t x, uint16_t y) const
+{
+    if (x >= width || y >= height)
+        return Color::White;
+
+    const size_t index = size_t{y} * bytesPerRow + x / 8;
+    const uint8_t mask = 0x80 >> (x % 8);
+
+    if (isRedShown && (panelRed[index] & mask))
+        return Color::Red;
+
+    return (panelBw[index] & mask) ? Color::White : Color::Black;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t SSD1675aEmulator::lutIndex(uint16_t x, uint16_t y) const
+{
+    if (x >= width || y >= height)
+        return 0;
+
+    const size_t index = size_t{y} * bytesPerRow + x / 8;
+    const uint8_t mask = 0x80 >> (x % 8);
+
+    return ((panelRed[index] & mask) ? 0b10 : 0) | ((panelBw[index] & mask) ? 0b01 : 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool SSD1675aEmulator::isPixelDriven(uint16_t x, uint16_t y) const
+{
+    if (lutRegister.size() < layout.size)
+        return true;
+
+    // voltage bytes of the LUT, one per phase
+    const uint8_t *voltages = lutRegister.data() + lutIndex(x, y) * layout.phases;
+
+    for (size_t phase = 0; phase < layout.phases; ++phase)
+    {
+        if (voltages[phase] != 0)
+            return true;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+uint64_t SSD1675aEmulator::lutDurationNs() const
+{
+    if (lutRegister.size() < layout.size)
+        return 0;
+
+    return lut_timing::durationUs(lutRegister.data(), layout, frameRate) * 1000;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::resetRegisters()
+{
+    entryMode = 0b011;
+    updateControl1 = 0;
+    updateControl2 = 0xFF;
+    xStart = 0;
+    xEnd = bytesPerRow - 1;
+    yStart = 0;
+    yEnd = height - 1;
+    xCounter = 0;
+    yCounter = 0;
+    temperatureSensor = InternalTemperatureSensor;
+    lutRegister.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::startCommand(uint8_t cmd)
+{
+    currentCommand = cmd;
+    parameterIndex = 0;
+    parameterWord = 0;
+
+    switch (cmd)
+    {
+    case command::SoftwareReset:
+        resetRegisters();
+        setBusy(ResetTimeNs);
+        break;
+
+    case command::MasterActivation:
+        activate();
+        break;
+
+    case command::WriteLUTRegister:
+        lutRegister.clear();
+        ++stats.lutUploads;
+        break;
+
+    default:
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::applyParameter(uint8_t value)
+{
+    const size_t index = parameterIndex++;
+
+    switch (currentCommand)
+    {
+    case command::DataEntryMode:
+        entryMode = value & 0b111;
+        break;
+
+    case command::DisplayUpdateControl1:
+        if (index == 0)
+            updateControl1 = value;
+        break;
+
+    case command::DisplayUpdateControl2:
+        updateControl2 = value;
+        break;
+
+    case command::TemperatureSensorControl:
+        temperatureSensor = value;
+        break;
+
+    case command::WriteTemperatureSensor:
+        if (index == 0)
+            parameterWord = value;
+        else if (index == 1)
+            temperatureValue = static_cast<int16_t>((parameterWord << 8) | value) >> 4;
+        break;
+
+    case command::WriteBWRam:
+        writeRam(bwPlane, value);
+        break;
+
+    case command::WriteRedRam:
+        writeRam(redPlane, value);
+        break;
+
+    case command::WriteLUTRegister:
+        if (lutRegister.size() < layout.size)
+            lutRegister.push_back(value);
+        break;
+
+    case command::AutoWriteRedRam:
+        if (index == 0)
+            autoWrite(redPlane, value);
+        break;
+
+    case command::AutoWriteBWRam:
+        if (index == 0)
+            autoWrite(bwPlane, value);
+        break;
+
+    case command::RamXStartEndPos:
+        if (index == 0)
+            xStart = value;
+        else if (index == 1)
+            xEnd = value;
+        break;
+
+    case command::RamYStartEndPos:
+        if (index % 2 == 0)
+            parameterWord = value;
+        else if (index == 1)
+            yStart = parameterWord | (value << 8);
+        else if (index == 3)
+            yEnd = parameterWord | (value << 8);
+        break;
+
+    case command::RamXCounter:
+        xCounter = value;
+        break;
+
+    case command::RamYCounter:
+        if (index == 0)
+            parameterWord = value;
+        else if (index == 1)
+            yCounter = parameterWord | (value << 8);
+        break;
+
+    case command::DeepSleep:
+    default:
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::writeRam(std::vector<uint8_t> &plane, uint8_t value)
+{
+    if (xCounter < bytesPerRow && yCounter < height)
+        plane[size_t{yCounter} * bytesPerRow + xCounter] = value;
+
+    advanceCounter();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::autoWrite(std::vector<uint8_t> &plane, uint8_t parameter)
+{
+    constexpr uint16_t StepHeights[] = {8, 16, 32, 64, 128, 256, 296, 296};
+    constexpr uint16_t StepWidths[] = {8, 16, 32, 64, 128, 256, 256, 256};
+
+    const bool firstValue = parameter & 0x80;
+    const uint16_t stepHeight = StepHeights[(parameter >> 4) & 0b111];
+    const uint16_t stepWidth = StepWidths[parameter & 0b111];
+
+    // checkerboard of steps, starting with the first value at the RAM origin
+    for (uint16_t y = 0; y < height; ++y)
+    {
+        for (uint16_t xByte = 0; xByte < bytesPerRow; ++xByte)
+        {
+            const bool isOdd = ((y / stepHeight) + (xByte * 8 / stepWidth)) % 2;
+            plane[size_t{y} * bytesPerRow + xByte] = (firstValue != isOdd) ? 0xFF : 0x00;
+        }
+    }
+
+    ++stats.autoWrites;
+    setBusy(AutoWriteTimeNs);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::advanceCounter()
+{
+    const bool isXIncrement = entryMode & 0b001;
+    const bool isYIncrement = entryMode & 0b010;
+    const bool isYFirst = entryMode & 0b100;
+
+    // returns true when the counter wrapped around at the end of the window
+    auto stepX = [&]() {
+        if (xCounter == xEnd)
+        {
+            xCounter = xStart;
+            return true;
+        }
+        xCounter += isXIncrement ? 1 : -1;
+        return false;
+    };
+
+    auto stepY = [&]() {
+        if (yCounter == yEnd)
+        {
+            yCounter = yStart;
+            return true;
+        }
+        yCounter += isYIncrement ? 1 : -1;
+        return false;
+    };
+
+    if (isYFirst)
+    {
+        if (stepY())
+            stepX();
+    }
+    else if (stepX())
+        stepY();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::activate()
+{
+    if ((updateControl2 & UpdateLoadTemperature) && temperatureSensor == InternalTemperatureSensor)
+        temperatureValue = sensorTemperature * 16;
+
+    // the waveform in OTP replaces the uploaded one
+    if (updateControl2 & UpdateLoadLut)
+        lutRegister.clear();
+
+    if (!(updateControl2 & UpdateDisplay))
+    {
+        setBusy(TemperatureLoadTimeNs);
+        return;
+    }
+
+    const uint8_t redOption = updateControl1 >> 4;
+    const uint8_t blackOption = updateControl1 & 0xF;
+
+    for (size_t i = 0; i < bwPlane.size(); ++i)
+    {
+        uint8_t bw = 0;
+        uint8_t red = 0;
+
+        for (uint8_t mask = 0x80; mask != 0; mask >>= 1)
+        {
+            if (applyRamOption(bwPlane[i] & mask, blackOption))
+                bw |= mask;
+
+            if (applyRamOption(redPlane[i] & mask, redOption))
+                red |= mask;
+        }
+
+        panelBw[i] = bw;
+        panelRed[i] = red;
+    }
+
+    const uint64_t waveformNs = lutDurationNs();
+    const uint64_t refreshNs = waveformNs != 0 ? waveformNs : otpRefreshNs;
+
+    ++stats.refreshes;
+    stats.lastRefreshNs = refreshNs;
+    setBusy(refreshNs);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::setBusy(uint64_t timeNs)
+{
+    waitUntilIdle();
+    busyUntilNs = nowNs + timeNs;
+    stats.busyTimeNs += timeNs;
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSD1675aEmulator::recordTransaction(size_t commandBytes, size_t dataBytes)
+{
+    stats.commandBytes += commandBytes;
+    stats.dataBytes += dataBytes;
+    ++stats.transactions;
+
+    if (busClockHz != 0)
+        nowNs += uint64_t{commandBytes + dataBytes} * 8 * 1'000'000'000 / busClockHz;
+}
@@ -1,10 +1,7 @@
 #include "ssd-display-driver/SSD1680.hpp"
-#include <array>
+#include "ssd-display-driver/LutComposer.hpp"
 
-namespace command
-{
-constexpr auto WriteLUTRegister = 0x32;
-}
+#include <array>
 
 // Waveforms
 
@@ -136,35 +133,84 @@ constexpr std::array<uint8_t, lutSize> Red = {
 // clang-format on
 } // namespace ssd1680_lut
 
+namespace
+{
+constexpr auto VSS = lut_composer::Voltage::VSS;
+constexpr auto VSH1 = lut_composer::Voltage::VSH1;
+constexpr auto VSL = lut_composer::Voltage::VSL;
+constexpr auto VSH2 = lut_composer::Voltage::VSH2;
+constexpr auto Idle = lut_composer::Idle;
+
+// The hand-packed waveforms described by their phases, LUT0 to LUT4 each.
+
+constexpr std::array<lut_composer::Phase, 5> DefaultPhases = {{
+    {{{{VSS, VSL, VSS, VSL},
+       {VSS, VSH1, VSS, VSH1},
+       {VSH1, VSL, VSL, VSL},
+       {VSH1, VSL, VSL, VSL},
+       Idle}},
+     {4, 24, 4, 22},
+     1},
+    {{{{VSS, VSH1, VSS, VSH1},
+       {VSL, VSS, VSL, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {10, 10, 10, 10},
+     2},
+    {{{{VSS, VSH1, VSS, VSS},
+       {VSL, VSS, VSS, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {0, 0, 0, 0}},
+    {{{Idle, {VSL, VSS, VSS, VSS}, {VSL, VSH1, VSL, VSH2}, {VSL, VSH1, VSL, VSH2}, Idle}},
+     {0, 0, 0, 0}},
+    {{{{VSS, VSH1, VSS, VSS},
+       {VSL, VSS, VSS, VSS},
+       {VSL, VSH1, VSL, VSH2},
+       {VSL, VSH1, VSL, VSH2},
+       Idle}},
+     {4, 4, 8, 60},
+     7},
+}};
+
+constexpr std::array<lut_composer::Phase, 1> DeltaPhases = {{
+    {{{Idle, {VSL, VSS, VSS, VSS}, {VSH1, VSS, VSS, VSS}, Idle, Idle}}, {24, 0, 0, 0}, 1},
+}};
+
+static_assert(lut_composer::isEqual(lut_composer::composeSSD1680(DefaultPhases),
+                                    ssd1680_lut::Default),
+              "Default matches its phases");
+static_assert(lut_composer::isEqual(lut_composer::composeSSD1680(DeltaPhases),
+                                    ssd1680_lut::Delta),
+              "Delta matches its phases");
+} // namespace
+
 //--------------------------------------------------------------------------------------------------
-void SSD1680::loadLut()
+const uint8_t *SSD1680::lutData(LutSelection selection) const
 {
     using namespace ssd1680_lut;
 
-    if (lutSelection == LutSelection::None)
-        return;
-
-    interface.writeCommand(command::WriteLUTRegister);
-
-    switch (lutSelection)
+    switch (selection)
     {
     case LutSelection::BlackWhite:
-        interface.writeData(reinterpret_cast<const uint8_t *>(BlackWhite.data()), lutSize);
-        break;
+        return BlackWhite.data();
 
     case LutSelection::Delta:
-        interface.writeData(reinterpret_cast<const uint8_t *>(Delta.data()), lutSize);
-        break;
+        return Delta.data();
 
     case LutSelection::Red:
-        interface.writeData(reinterpret_cast<const uint8_t *>(Red.data()), lutSize);
-        break;
+        return Red.data();
 
     case LutSelection::Default:
     default:
-        interface.writeData(reinterpret_cast<const uint8_t *>(Default.data()), lutSize);
-        break;
+        return Default.data();
     }
+}
 
-    interface.waitUntilIdle();
-}
\ No newline at end of file
+//--------------------------------------------------------------------------------------------------
+const lut_timing::Layout &SSD1680::lutLayout() const
+{
+    return lut_timing::SSD1680;
+}
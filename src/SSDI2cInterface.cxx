@@ -0,0 +1,86 @@
+#include "ssd-display-driver/SSDI2cInterface.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+/// Control bytes with the continuation bit Co cleared, so all following bytes of the
+/// transaction are commands or data respectively.
+constexpr uint8_t CommandStream = 0x00;
+constexpr uint8_t DataStream = 0x40;
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::writeCommand(uint8_t cmd)
+{
+    writeCommands(&cmd, 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::writeCommands(const uint8_t *cmds, size_t length)
+{
+    append(CommandStream, cmds, length);
+    flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::writeData(uint8_t data)
+{
+    writeData(&data, 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::writeData(const uint8_t *data, size_t length)
+{
+    append(DataStream, data, length);
+    flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::writeSegments(const Segment *segments, size_t numberOfSegments)
+{
+    for (size_t i = 0; i < numberOfSegments; ++i)
+    {
+        const bool isCommand = segments[i].type == Segment::Type::Command;
+        append(isCommand ? CommandStream : DataStream, segments[i].data, segments[i].length);
+    }
+
+    flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::append(uint8_t control, const uint8_t *bytes, size_t length)
+{
+    // no room for any byte behind the control byte, see the precondition of the constructor
+    assert(maxTransferSize >= 2);
+    if (maxTransferSize < 2)
+        return;
+
+    while (length > 0)
+    {
+        if (transferLength > 0 &&
+            (transferBuffer[0] != control || transferLength == maxTransferSize))
+            flush();
+
+        if (transferLength == 0)
+            transferBuffer[transferLength++] = control;
+
+        const size_t count = std::min(length, maxTransferSize - transferLength);
+        std::memcpy(transferBuffer + transferLength, bytes, count);
+
+        transferLength += count;
+        bytes += count;
+        length -= count;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void SSDI2cInterface::flush()
+{
+    if (transferLength > 1)
+        bus.write(address, transferBuffer, transferLength);
+
+    transferLength = 0;
+}
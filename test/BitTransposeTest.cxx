@@ -0,0 +1,86 @@
+#include "ssd-display-driver/BitTranspose.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+using bit_transpose::Mirror;
+
+constexpr Mirror Mirrors[] = {Mirror::None, Mirror::Horizontal, Mirror::Vertical, Mirror::Both};
+
+/// Deterministic pseudo random bytes, xorshift32.
+uint8_t nextByte(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<uint8_t>(state);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool check(size_t width, size_t height, Mirror mirror, uint32_t &state)
+{
+    const size_t imageLength = (width + 7) / 8 * height;
+    const size_t pageMajorLength = width * ((height + 7) / 8);
+
+    // exact sizes, so out of bounds accesses are found by the sanitizers
+    std::vector<uint8_t> image(imageLength);
+    for (auto &byte : image)
+        byte = nextByte(state);
+
+    std::vector<uint8_t> expected(pageMajorLength);
+    std::vector<uint8_t> actual(pageMajorLength, 0xA5);
+
+    bit_transpose::rowMajorToPageMajorReference(image.data(), width, height, expected.data(),
+                                                mirror);
+    bit_transpose::rowMajorToPageMajor(image.data(), width, height, actual.data(), mirror);
+
+    if (expected == actual)
+        return true;
+
+    std::printf("mismatch: width %zu, height %zu, mirror %u\n", width, height,
+                static_cast<unsigned>(mirror));
+    return false;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Compares the conversion, built with the vector extensions selected by the compiler flags (see
+/// CMakeLists.txt), with the bit by bit reference.
+int main()
+{
+    // every remainder of the 8, 16 and 32 byte blocks of the vector paths, the OLED widths and
+    // the fallback beyond MaxWidth
+    std::vector<size_t> widths;
+    for (size_t width = 1; width <= 300; ++width)
+        widths.push_back(width);
+
+    for (size_t width : {511, 512, 513, 1023, 1024, 1025, 2047, 2048, 2049})
+        widths.push_back(width);
+
+    const size_t heights[] = {1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65};
+
+    uint32_t state = 0x12345678;
+    size_t failures = 0;
+    size_t cases = 0;
+
+    for (const size_t width : widths)
+    {
+        for (const size_t height : heights)
+        {
+            for (const Mirror mirror : Mirrors)
+            {
+                ++cases;
+
+                if (!check(width, height, mirror, state))
+                    ++failures;
+            }
+        }
+    }
+
+    std::printf("%zu of %zu cases failed\n", failures, cases);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "ssd-display-driver/ColorPlanes.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+using color_planes::PlaneFormat;
+
+constexpr PlaneFormat Formats[] = {{false, false}, {true, false}, {false, true}, {true, true}};
+
+/// Deterministic pseudo random bytes, xorshift32.
+uint8_t nextByte(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<uint8_t>(state);
+}
+
+/// Sets the bits of one pixel of both planes as given by the datasheet: a set BW bit is white, a
+/// set red bit is red, each one inverted by \p format. Other indices than Black and Red are white.
+void setPixelReference(uint8_t index, size_t x, uint8_t *bw, uint8_t *red, PlaneFormat format)
+{
+    const uint8_t mask = 0x80 >> (x % 8);
+    const bool isBwSet = (index != color_planes::Black) != format.invertBlack;
+    const bool isRedSet = (index == color_planes::Red) != format.invertRed;
+
+    bw[x / 8] = isBwSet ? (bw[x / 8] | mask) : (bw[x / 8] & ~mask);
+    red[x / 8] = isRedSet ? (red[x / 8] | mask) : (red[x / 8] & ~mask);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Packs both planes pixel by pixel, the padding pixels of the last byte of a row being white.
+/// \param pixelsPerByte 1 for 8bpp and 4 for 2bpp images.
+void packReference(const uint8_t *pixels, size_t width, size_t rows, uint8_t *bwPlane,
+                   uint8_t *redPlane, PlaneFormat format, size_t pixelsPerByte)
+{
+    const size_t bytesPerRow = (width + 7) / 8;
+    const size_t sourceBytesPerRow = (width + pixelsPerByte - 1) / pixelsPerByte;
+    const size_t bitsPerPixel = 8 / pixelsPerByte;
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const uint8_t *source = pixels + row * sourceBytesPerRow;
+        uint8_t *bw = bwPlane + row * bytesPerRow;
+        uint8_t *red = redPlane + row * bytesPerRow;
+
+        for (size_t x = 0; x < bytesPerRow * 8; ++x)
+        {
+            uint8_t index = color_planes::White;
+
+            if (x < width)
+            {
+                const size_t shift = 8 - bitsPerPixel * (x % pixelsPerByte + 1);
+                index = (source[x / pixelsPerByte] >> shift) & (0xFF >> (8 - bitsPerPixel));
+            }
+
+            setPixelReference(index, x, bw, red, format);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+bool check(size_t width, size_t rows, PlaneFormat format, size_t pixelsPerByte, uint32_t &state)
+{
+    const size_t sourceLength = (width + pixelsPerByte - 1) / pixelsPerByte * rows;
+    const size_t planeLength = (width + 7) / 8 * rows;
+
+    // exact sizes, so out of bounds accesses are found by the sanitizers
+    std::vector<uint8_t> pixels(sourceLength);
+    for (auto &byte : pixels)
+    {
+        // 8bpp images mostly consist of valid indices, with some others to be taken as white
+        const uint8_t value = nextByte(state);
+        byte = (pixelsPerByte == 4 || value >= 0xF0) ? value : value % 3;
+    }
+
+    std::vector<uint8_t> expectedBw(planeLength);
+    std::vector<uint8_t> expectedRed(planeLength);
+    std::vector<uint8_t> actualBw(planeLength, 0xA5);
+    std::vector<uint8_t> actualRed(planeLength, 0x5A);
+
+    packReference(pixels.data(), width, rows, expectedBw.data(), expectedRed.data(), format,
+                  pixelsPerByte);
+
+    if (pixelsPerByte == 1)
+        color_planes::pack8bpp(pixels.data(), width, rows, actualBw.data(), actualRed.data(),
+                               format);
+    else
+        color_planes::pack2bpp(pixels.data(), width, rows, actualBw.data(), actualRed.data(),
+                               format);
+
+    if (expectedBw == actualBw && expectedRed == actualRed)
+        return true;
+
+    std::printf("mismatch: %zubpp, width %zu, rows %zu, invertBlack %d, invertRed %d\n",
+                8 / pixelsPerByte, width, rows, format.invertBlack, format.invertRed);
+    return false;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Compares both packers, built with the vector extensions selected by the compiler flags (see
+/// CMakeLists.txt), with the pixel by pixel reference.
+int main()
+{
+    // every remainder of the 8, 16 and 32 pixel blocks of the 8bpp paths and of the 4 pixel
+    // bytes of 2bpp images
+    std::vector<size_t> widths;
+    for (size_t width = 1; width <= 300; ++width)
+        widths.push_back(width);
+
+    const size_t rows[] = {1, 2, 3, 7};
+
+    uint32_t state = 0x9E3779B9;
+    size_t failures = 0;
+    size_t cases = 0;
+
+    for (const size_t pixelsPerByte : {1, 4})
+    {
+        for (const size_t width : widths)
+        {
+            for (const size_t rowCount : rows)
+            {
+                for (const PlaneFormat format : Formats)
+                {
+                    ++cases;
+
+                    if (!check(width, rowCount, format, pixelsPerByte, state))
+                        ++failures;
+                }
+            }
+        }
+    }
+
+    std::printf("%zu of %zu cases failed\n", failures, cases);
+    return failures == 0 ? 0 : 1;
+}
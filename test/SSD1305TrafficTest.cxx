@@ -0,0 +1,320 @@
+#include "ssd-display-driver/SSD1305.hpp"
+#include "ssd-display-driver/SSD1305Emulator.hpp"
+#include "ssd-display-driver/SSD1306.hpp"
+#include "ssd-display-driver/SSDAsyncInterface.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+using Bus = SSD1305Emulator::Bus;
+using ByteType = SSD1305Emulator::ByteType;
+using Variant = SSD1305Emulator::Variant;
+
+constexpr uint8_t Width = 128;
+constexpr uint8_t Pages = 8;
+constexpr size_t ImageLength = Width * Pages;
+
+size_t failures = 0;
+
+void expect(bool condition, const char *description)
+{
+    if (condition)
+        return;
+
+    std::printf("failed: %s\n", description);
+    ++failures;
+}
+
+bool isRamEqual(const SSD1305Emulator &emulator, const uint8_t *image)
+{
+    for (uint8_t page = 0; page < Pages; ++page)
+    {
+        for (uint8_t column = 0; column < Width; ++column)
+        {
+            if (emulator.ram(column, page) != image[page * Width + column])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/// \return Command bytes of the trace.
+std::vector<uint8_t> tracedCommands(const SSD1305Emulator &emulator)
+{
+    std::vector<uint8_t> commands;
+    for (const auto &entry : emulator.trace())
+        if (entry.type == ByteType::Command)
+            commands.push_back(entry.value);
+
+    return commands;
+}
+
+/// Sets up a full screen window in horizontal addressing mode.
+void setUpHorizontalMode(SSD1305 &display)
+{
+    display.setMemoryAddressingMode(SSD1305::AddressingMode::Horizontal);
+    display.setColumnAddress(0, Width - 1);
+    display.setPageAddress(0, Pages - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+void testDifferentialUpdate()
+{
+    SSD1305Emulator emulator(Variant::SSD1306);
+    SSD1305 display(emulator);
+    setUpHorizontalMode(display);
+
+    std::array<uint8_t, ImageLength> image{};
+    std::array<uint8_t, ImageLength> shadow{};
+    display.enableDifferentialUpdate(shadow.data(), shadow.size(), Width);
+
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(i * 37);
+
+    emulator.clearTrace();
+    display.submitImage(image.data(), image.size());
+    expect(emulator.totalTraffic().dataBytes == ImageLength, "first frame is sent completely");
+    expect(isRamEqual(emulator, image.data()), "first frame lands in the GDDRAM");
+
+    emulator.clearTrace();
+    display.submitImage(image.data(), image.size());
+    expect(emulator.totalTraffic().dataBytes == 0, "unchanged frame sends no data");
+
+    // two spans on page 1, which are too far apart to be merged, and one on page 6
+    image[1 * Width + 10] ^= 0xFF;
+    image[1 * Width + 11] ^= 0xFF;
+    image[1 * Width + 100] ^= 0x01;
+    image[6 * Width + 127] ^= 0x80;
+
+    emulator.clearTrace();
+    display.submitImage(image.data(), image.size());
+    expect(emulator.totalTraffic().dataBytes == 4, "only the changed bytes are sent");
+    expect(emulator.totalTraffic().commandBytes <= 3 * 6, "one window per span");
+    expect(isRamEqual(emulator, image.data()), "changed spans land in the GDDRAM");
+
+    // spans separated by a short gap are sent as one
+    image[3 * Width + 20] ^= 0x01;
+    image[3 * Width + 24] ^= 0x01;
+
+    emulator.clearTrace();
+    display.submitImage(image.data(), image.size());
+    expect(emulator.totalTraffic().dataBytes == 5, "short gaps are merged");
+    expect(isRamEqual(emulator, image.data()), "merged span lands in the GDDRAM");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testI2cFraming()
+{
+    SSD1305Emulator emulator(Variant::SSD1306, Bus::I2c, 400'000);
+    SSD1305 display(emulator);
+
+    // each setter is a transaction of its own
+    emulator.clearTrace();
+    display.setContrastControl(0x40);
+    display.setDisplayOffset(3);
+    display.setDisplayStartLine(5);
+
+    const auto single = emulator.totalTraffic();
+    expect(single.transactions == 3, "setters outside a transaction are sent one by one");
+    expect(single.wireBytes == single.commandBytes + 3 * 2,
+           "each transaction carries address and control byte");
+
+    // collected into a single transaction
+    emulator.clearTrace();
+    display.beginTransaction();
+    display.setContrastControl(0x41);
+    display.setDisplayOffset(4);
+    display.setDisplayStartLine(6);
+    display.endTransaction();
+
+    const auto batched = emulator.totalTraffic();
+    expect(batched.transactions == 1, "transaction sends the commands at once");
+    expect(batched.commandBytes == single.commandBytes, "transaction sends the same commands");
+    expect(batched.wireBytes == single.wireBytes - 2 * 2, "transaction saves the framing bytes");
+    expect(batched.transferTimeNs < single.transferTimeNs, "transaction is faster on the bus");
+    expect(emulator.contrast() == 0x41 && emulator.displayStartLine() == 6,
+           "batched commands are decoded");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testReadModifyWrite()
+{
+    SSD1305Emulator emulator(Variant::SSD1306, Bus::Parallel, 10'000'000);
+    SSD1305 display(emulator);
+    setUpHorizontalMode(display);
+
+    std::array<uint8_t, ImageLength> image{};
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(i * 13);
+
+    display.submitImage(image.data(), image.size());
+
+    // far more bytes than the byte cache holds, without a shadow copy
+    for (uint8_t x = 0; x < Width; ++x)
+    {
+        for (uint8_t y = 0; y < Pages * 8; y += 3)
+        {
+            expect(display.setPixel(x, y), "pixel update succeeds with a readable bus");
+            image[(y / 8) * Width + x] |= 1 << (y % 8);
+        }
+    }
+
+    expect(display.rejectedPixelUpdates() == 0, "no pixel update is rejected");
+    expect(emulator.totalTraffic().readBytes > 0, "GDDRAM is read back");
+    expect(!emulator.isReadModifyWrite(), "read-modify-write mode is left");
+    expect(isRamEqual(emulator, image.data()), "pixels of other bytes are kept");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testAsyncImageInTransaction()
+{
+    SSD1305Emulator emulator(Variant::SSD1306);
+    BlockingAsyncAdapter adapter(emulator);
+    SSD1305 display(adapter);
+    setUpHorizontalMode(display);
+
+    std::array<uint8_t, ImageLength> image{};
+    std::array<uint8_t, ImageLength> shadow{};
+    display.enableDifferentialUpdate(shadow.data(), shadow.size(), Width);
+    display.submitImage(image.data(), image.size());
+
+    // narrows the window to a single span
+    image[5 * Width + 70] = 0x55;
+    display.submitImage(image.data(), image.size());
+
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(i * 7 + 1);
+
+    // the full window has to be restored before the image is transferred
+    display.beginTransaction();
+    display.submitImageAsync(image.data(), image.size());
+    display.endTransaction();
+    display.waitForImageTransfer();
+
+    expect(isRamEqual(emulator, image.data()), "async image inside a transaction is addressed");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testSegmentedTransaction()
+{
+    SSD1305Emulator emulator(Variant::SSD1306, Bus::I2c, 400'000);
+    BlockingAsyncAdapter adapter(emulator);
+    SSD1305 display(adapter);
+    setUpHorizontalMode(display);
+
+    std::array<uint8_t, ImageLength> image{};
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(i * 11 + 3);
+
+    // the commands and the image are sent as segments of one interface call
+    emulator.clearTrace();
+    display.beginTransaction();
+    display.setContrastControl(0x20);
+    display.submitImage(image.data(), image.size());
+    display.endTransaction();
+
+    bool isOneTransaction = true;
+    for (const auto &entry : emulator.trace())
+        isOneTransaction = isOneTransaction && entry.transaction == 0;
+
+    const auto traffic = emulator.totalTraffic();
+    expect(traffic.transactions == 1, "segments are forwarded as one transaction");
+    expect(isOneTransaction, "all bytes belong to the same transaction");
+    expect(traffic.dataBytes == ImageLength, "image is sent once");
+    expect(traffic.wireBytes == traffic.commandBytes + traffic.dataBytes + 2 * 2,
+           "I2C frames the command and the data run once each");
+    expect(emulator.contrast() == 0x20, "command segment is decoded");
+    expect(isRamEqual(emulator, image.data()), "data segment lands in the GDDRAM");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testScrollSetupThroughBase()
+{
+    SSD1305Emulator emulator(Variant::SSD1306);
+    SSD1306 ssd1306(emulator);
+    SSD1305 &display = ssd1306;
+
+    emulator.clearTrace();
+    display.setupHorizontalScroll(SSD1305::ScrollDirection::Left, 1, 6,
+                                  SSD1305::ScrollInterval::Frames25);
+    display.setContrastControl(0x42);
+
+    const std::vector<uint8_t> horizontal = {0x2E, 0x27, 0x00, 0x01, 0b110, 0x06, 0x00, 0xFF,
+                                             0x81, 0x42};
+    expect(tracedCommands(emulator) == horizontal, "horizontal scroll has the SSD1306 framing");
+    expect(emulator.contrast() == 0x42, "command after the scroll setup is decoded");
+
+    emulator.clearTrace();
+    display.setupDiagonalScroll(SSD1305::ScrollDirection::Right, 0, 7,
+                                SSD1305::ScrollInterval::Frames64, 5);
+
+    const std::vector<uint8_t> diagonal = {0x29, 0x00, 0x00, 0b001, 0x07, 0x05};
+    expect(tracedCommands(emulator) == diagonal, "diagonal scroll has the SSD1306 framing");
+
+    // a SSD1305 keeps its own framing and has no charge pump
+    SSD1305Emulator ssd1305Emulator(Variant::SSD1305);
+    SSD1305 ssd1305(ssd1305Emulator);
+
+    ssd1305.setupHorizontalScroll(SSD1305::ScrollDirection::Left, 1, 6,
+                                  SSD1305::ScrollInterval::Frames32, 2);
+    ssd1305.setChargePump(true);
+
+    const std::vector<uint8_t> ssd1305Horizontal = {0x2E, 0x27, 0x02, 0x01, 0b001, 0x06};
+    expect(tracedCommands(ssd1305Emulator) == ssd1305Horizontal,
+           "SSD1305 scroll has the SSD1305 framing, the charge pump is ignored");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testRestoreOtherVariant()
+{
+    SSD1305Emulator emulator(Variant::SSD1306);
+    SSD1306 ssd1306(emulator);
+    ssd1306.setContrastControl(0x30);
+    ssd1306.setChargePump(true);
+    ssd1306.setupHorizontalScroll(SSD1305::ScrollDirection::Right, 0, 7,
+                                  SSD1305::ScrollInterval::Frames2);
+    ssd1306.activateScroll();
+
+    // the same variant replays all registers
+    SSD1305Emulator sameEmulator(Variant::SSD1306);
+    SSD1306 same(sameEmulator);
+    same.restore(ssd1306.snapshot());
+    const std::vector<uint8_t> all = {0x81, 0x30, 0x8D, 0x14, 0x26, 0x00, 0x00,
+                                      0b111, 0x07, 0x00, 0xFF, 0x2F};
+    expect(tracedCommands(sameEmulator) == all,
+           "snapshot of the same variant is replayed completely");
+    expect(sameEmulator.isScrollActive(), "scrolling is activated again");
+
+    // the charge pump and scroll setup of a SSD1306 are not understood by a SSD1305
+    SSD1305Emulator otherEmulator(Variant::SSD1305);
+    SSD1305 other(otherEmulator);
+    other.restore(ssd1306.snapshot());
+
+    const std::vector<uint8_t> contrastOnly = {0x81, 0x30};
+    expect(tracedCommands(otherEmulator) == contrastOnly,
+           "variant specific registers of another variant are skipped");
+    expect(other.snapshot().lengths[static_cast<size_t>(SSD1305::Register::ChargePump)] == 0,
+           "skipped registers are not kept");
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Checks the bus traffic of the SSD1305 driver and its effect on the GDDRAM with the emulator.
+int main()
+{
+    testDifferentialUpdate();
+    testI2cFraming();
+    testReadModifyWrite();
+    testAsyncImageInTransaction();
+    testSegmentedTransaction();
+    testScrollSetupThroughBase();
+    testRestoreOtherVariant();
+
+    std::printf("%zu checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+#include "ssd-display-driver/SSD1675a.hpp"
+#include "ssd-display-driver/SSD1675aEmulator.hpp"
+#include "ssd-display-driver/SSD1680.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+using Variant = SSD1675aEmulator::Variant;
+using LutSelection = SSD1675a::LutSelection;
+
+constexpr uint16_t Width = 152;
+constexpr uint16_t Height = 296;
+constexpr uint16_t BytesPerRow = Width / 8;
+constexpr size_t PlaneLength = size_t{BytesPerRow} * Height;
+
+// clang-format off
+constexpr uint8_t DataEntryMode    = 0x11;
+constexpr uint8_t WriteBWRam       = 0x24;
+constexpr uint8_t RamXStartEndPos  = 0x44;
+constexpr uint8_t RamYStartEndPos  = 0x45;
+constexpr uint8_t RamXCounter      = 0x4E;
+constexpr uint8_t RamYCounter      = 0x4F;
+// clang-format on
+
+size_t failures = 0;
+
+void expect(bool condition, const char *description)
+{
+    if (condition)
+        return;
+
+    std::printf("failed: %s\n", description);
+    ++failures;
+}
+
+/// Waveform duration in ns as given by the datasheets, independent of lut_timing: every phase
+/// takes the sum of its sub phase frames times its repeat count plus one.
+uint64_t expectedDurationNs(const std::vector<uint8_t> &lut, Variant variant)
+{
+    uint64_t durationNs = 0;
+
+    if (variant == Variant::SSD1675a)
+    {
+        // 5 x 7 voltage bytes, TPA TPB TPC TPD RP per phase, 50 Hz
+        for (size_t phase = 0; phase < 7; ++phase)
+        {
+            const uint8_t *t = &lut[35 + phase * 5];
+            durationNs += (uint64_t{t[0]} + t[1] + t[2] + t[3]) * (t[4] + 1u) * 20'000'000;
+        }
+
+        return durationNs;
+    }
+
+    // 5 x 12 voltage bytes, TPA TPB SRAB TPC TPD SRCD RP per phase, frame rate nibbles
+    for (size_t phase = 0; phase < 12; ++phase)
+    {
+        const uint8_t *t = &lut[60 + phase * 7];
+        const uint64_t frames =
+            ((t[0] + t[1]) * (t[2] + 1u) + (t[3] + t[4]) * (t[5] + 1u)) * (t[6] + 1u);
+
+        const uint8_t frameRateByte = lut[144 + phase / 2];
+        const uint8_t setting = (phase % 2 == 0 ? frameRateByte >> 4 : frameRateByte) & 0xF;
+        const uint64_t frameRateMilliHz = 25'000 + setting * 6'250;
+
+        durationNs += frames * 1'000'000'000'000 / frameRateMilliHz;
+    }
+
+    return durationNs;
+}
+
+//--------------------------------------------------------------------------------------------------
+void testRefreshBusyTime(SSD1675a &display, SSD1675aEmulator &emulator, Variant variant)
+{
+    display.selectLut(LutSelection::Default);
+    display.init();
+    expect(emulator.lut().size() == (variant == Variant::SSD1680 ? 153 : 70),
+           "init uploads the whole LUT");
+
+    const std::vector<uint8_t> image(PlaneLength, 0xFF);
+
+    emulator.clearStatistics();
+    const uint64_t start = emulator.now();
+    display.submitPlanes(image.data(), nullptr, image.size());
+
+    const uint64_t expected = expectedDurationNs(emulator.lut(), variant);
+    const auto &statistics = emulator.statistics();
+
+    expect(expected > 0, "Default waveform has frames");
+    expect(statistics.refreshes == 1, "submitPlanes refreshes once");
+    expect(statistics.lastRefreshNs / 1000 == expected / 1000,
+           "busy time of the refresh is the duration of the Default LUT");
+    expect(emulator.now() - start >= statistics.lastRefreshNs, "driver waits for the busy pin");
+    expect(!emulator.isBusy(), "controller is idle afterwards");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testBusyTime()
+{
+    SSD1675aEmulator ssd1675aEmulator(Variant::SSD1675a);
+    SSD1675a ssd1675a(ssd1675aEmulator);
+    testRefreshBusyTime(ssd1675a, ssd1675aEmulator, Variant::SSD1675a);
+
+    SSD1675aEmulator ssd1680Emulator(Variant::SSD1680);
+    SSD1680 ssd1680(ssd1680Emulator);
+    testRefreshBusyTime(ssd1680, ssd1680Emulator, Variant::SSD1680);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Writes a window of 3 x 4 bytes with each data entry mode, the start position being the
+/// first one to be written, and checks where the bytes land.
+void testDataEntryModes()
+{
+    constexpr uint8_t XLow = 2;
+    constexpr uint8_t XHigh = 4;
+    constexpr uint16_t YLow = 10;
+    constexpr uint16_t YHigh = 13;
+
+    for (uint8_t mode = 0; mode < 8; ++mode)
+    {
+        SSD1675aEmulator emulator;
+
+        const bool isXIncrement = mode & 0b001;
+        const bool isYIncrement = mode & 0b010;
+        const bool isYFirst = mode & 0b100;
+
+        const uint8_t xStart = isXIncrement ? XLow : XHigh;
+        const uint8_t xEnd = isXIncrement ? XHigh : XLow;
+        const uint16_t yStart = isYIncrement ? YLow : YHigh;
+        const uint16_t yEnd = isYIncrement ? YHigh : YLow;
+
+        emulator.writeCommand(DataEntryMode);
+        emulator.writeData(mode);
+        emulator.writeCommand(RamXStartEndPos);
+        emulator.writeData(xStart);
+        emulator.writeData(xEnd);
+        emulator.writeCommand(RamYStartEndPos);
+        emulator.writeData(yStart & 0xFF);
+        emulator.writeData(yStart >> 8);
+        emulator.writeData(yEnd & 0xFF);
+        emulator.writeData(yEnd >> 8);
+        emulator.writeCommand(RamXCounter);
+        emulator.writeData(xStart);
+        emulator.writeCommand(RamYCounter);
+        emulator.writeData(yStart & 0xFF);
+        emulator.writeData(yStart >> 8);
+
+        emulator.writeCommand(WriteBWRam);
+        for (uint8_t value = 1; value <= 12; ++value)
+            emulator.writeData(value);
+
+        expect(emulator.dataEntryMode() == mode, "data entry mode is decoded");
+
+        // the expected order, the inner loop being the direction given by bit 2
+        uint8_t value = 1;
+        bool isPlaced = true;
+
+        for (int outer = 0; outer < (isYFirst ? 3 : 4); ++outer)
+        {
+            for (int inner = 0; inner < (isYFirst ? 4 : 3); ++inner, ++value)
+            {
+                const int xStep = isYFirst ? outer : inner;
+                const int yStep = isYFirst ? inner : outer;
+
+                const uint16_t x = isXIncrement ? XLow + xStep : XHigh - xStep;
+                const uint16_t y = isYIncrement ? YLow + yStep : YHigh - yStep;
+
+                isPlaced = isPlaced && emulator.bwRam(x, y) == value;
+            }
+        }
+
+        expect(isPlaced, "window is written in the order of the data entry mode");
+        const bool isOutsideKept =
+            emulator.bwRam(XLow - 1, YLow) == 0xFF && emulator.bwRam(XHigh + 1, YHigh) == 0xFF &&
+            emulator.bwRam(XLow, YLow - 1) == 0xFF && emulator.bwRam(XHigh, YHigh + 1) == 0xFF;
+        expect(isOutsideKept, "bytes outside the window are kept");
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void testWindowedWrite()
+{
+    SSD1675aEmulator emulator;
+    SSD1675a display(emulator);
+    display.selectLut(LutSelection::Default);
+    display.init();
+
+    const SSD1675a::Window window{16, 40, 24, 5};
+    std::vector<uint8_t> image(3 * 5);
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(0x10 + i);
+
+    const std::vector<uint8_t> red(image.size(), 0x00);
+    display.submitPlanes(image.data(), red.data(), window, false);
+
+    // init() counts Y downwards, so the first row of the image is the last row of the window
+    bool isPlaced = true;
+    for (uint16_t row = 0; row < window.height; ++row)
+    {
+        for (uint16_t column = 0; column < 3; ++column)
+            isPlaced = isPlaced && emulator.bwRam(2 + column, 44 - row) == image[row * 3 + column];
+    }
+
+    expect(isPlaced, "window lands at its RAM rows and byte columns");
+    expect(emulator.bwRam(2, 39) == 0xFF && emulator.bwRam(2, 45) == 0xFF &&
+               emulator.bwRam(1, 40) == 0xFF && emulator.bwRam(5, 40) == 0xFF,
+           "windowed write keeps the surrounding RAM");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testTemperatureKeepsSequence()
+{
+    constexpr uint64_t OtpRefreshNs = 3'000'000'000;
+    const std::vector<uint8_t> image(PlaneLength, 0xFF);
+
+    // with a LUT, the refreshes use the uploaded one
+    SSD1675aEmulator emulator;
+    SSD1675a display(emulator);
+    display.selectLut(LutSelection::Default);
+    display.init();
+
+    int8_t celsius = 0;
+    expect(display.readTemperature(celsius), "temperature is read");
+    expect(emulator.displayUpdateSequence() == 0xCF, "LUT refresh sequence is restored");
+
+    // a sequence set by the user is kept as well
+    display.setDisplayUpdateControl2(0xC7);
+    display.readTemperature(celsius);
+    expect(emulator.displayUpdateSequence() == 0xC7, "user sequence is restored");
+
+    // without a LUT, the refreshes load the one in OTP
+    SSD1675aEmulator otpEmulator;
+    otpEmulator.setOtpRefreshTime(OtpRefreshNs);
+    SSD1675a otpDisplay(otpEmulator);
+    otpDisplay.init();
+    otpDisplay.readTemperature(celsius);
+    expect(otpEmulator.displayUpdateSequence() == 0xFF, "OTP refresh sequence is restored");
+    otpDisplay.submitPlanes(image.data(), nullptr, image.size());
+
+    expect(otpEmulator.statistics().refreshes == 1, "refresh without a LUT");
+    expect(otpEmulator.statistics().lastRefreshNs == OtpRefreshNs,
+           "refresh after reading the temperature uses the LUT in OTP");
+
+    // switching to the LUT in OTP replaces the uploaded one
+    expect(display.startRefresh(LutSelection::None), "refresh is started");
+    emulator.waitUntilIdle();
+    expect(display.poll(), "refresh has completed");
+    expect(emulator.lut().empty(), "refresh without a LUT loads the one in OTP");
+    expect(display.residentLut() == LutSelection::None, "uploaded LUT is not resident anymore");
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Checks the command decoding and the LUT derived busy time of the ePaper emulator.
+int main()
+{
+    testBusyTime();
+    testDataEntryModes();
+    testWindowedWrite();
+    testTemperatureKeepsSequence();
+
+    std::printf("%zu checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
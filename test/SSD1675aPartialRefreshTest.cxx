@@ -0,0 +1,162 @@
+#include "ssd-display-driver/SSD1675a.hpp"
+#include "ssd-display-driver/SSD1675aEmulator.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+using LutSelection = SSD1675a::LutSelection;
+
+constexpr uint16_t Width = 152;
+constexpr uint16_t Height = 296;
+constexpr uint16_t BytesPerRow = Width / 8;
+constexpr size_t PlaneLength = size_t{BytesPerRow} * Height;
+
+size_t failures = 0;
+
+void expect(bool condition, const char *description)
+{
+    if (condition)
+        return;
+
+    std::printf("failed: %s\n", description);
+    ++failures;
+}
+
+std::vector<uint8_t> readBwRam(const SSD1675aEmulator &emulator)
+{
+    std::vector<uint8_t> ram(PlaneLength);
+
+    for (uint16_t y = 0; y < Height; ++y)
+    {
+        for (uint16_t xByte = 0; xByte < BytesPerRow; ++xByte)
+            ram[size_t{y} * BytesPerRow + xByte] = emulator.bwRam(xByte, y);
+    }
+
+    return ram;
+}
+
+/// Checks that the last refresh drove exactly the pixels which changed between the BW RAM
+/// contents \p previous and \p current, each with the LUT of its transition.
+/// \return Number of changed pixels.
+size_t checkDrivenPixels(const SSD1675aEmulator &emulator, const std::vector<uint8_t> &previous,
+                         const std::vector<uint8_t> &current)
+{
+    size_t changedPixels = 0;
+    bool isDrivenAsChanged = true;
+    bool isLutOfTransition = true;
+
+    for (uint16_t y = 0; y < Height; ++y)
+    {
+        for (uint16_t x = 0; x < Width; ++x)
+        {
+            const size_t index = size_t{y} * BytesPerRow + x / 8;
+            const uint8_t mask = 0x80 >> (x % 8);
+
+            // the BW RAM is inverted by init(), a set bit is black
+            const bool wasBlack = previous[index] & mask;
+            const bool isBlack = current[index] & mask;
+            const bool isChanged = wasBlack != isBlack;
+
+            // LUT1 drives black to white, LUT2 white to black, LUT0 and LUT3 are empty
+            const uint8_t expectedLut = isChanged ? (wasBlack ? 1 : 2) : (wasBlack ? 0 : 3);
+
+            changedPixels += isChanged;
+            isDrivenAsChanged = isDrivenAsChanged && emulator.isPixelDriven(x, y) == isChanged;
+            isLutOfTransition = isLutOfTransition && emulator.lutIndex(x, y) == expectedLut;
+        }
+    }
+
+    expect(isDrivenAsChanged, "only the changed pixels are driven");
+    expect(isLutOfTransition, "each pixel uses the LUT of its transition");
+    return changedPixels;
+}
+
+std::vector<uint8_t> makeImage(uint8_t seed)
+{
+    std::vector<uint8_t> image(PlaneLength);
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<uint8_t>(i * 29 + seed);
+
+    return image;
+}
+
+/// Partially refreshes a window with changed content and checks the driven pixels.
+void checkPartialRefresh(SSD1675a &display, SSD1675aEmulator &emulator,
+                         const SSD1675a::Window &window, uint8_t pattern)
+{
+    std::vector<uint8_t> windowImage(window.width / 8 * window.height, pattern);
+
+    const auto previous = readBwRam(emulator);
+    const auto refreshes = emulator.statistics().refreshes;
+
+    display.partialRefresh(windowImage.data(), window);
+
+    expect(emulator.statistics().refreshes == refreshes + 1, "partial refresh refreshes once");
+    expect(display.residentLut() == LutSelection::Delta, "partial refresh uses Delta");
+
+    const size_t changedPixels = checkDrivenPixels(emulator, previous, readBwRam(emulator));
+    expect(changedPixels > 0, "window changes pixels");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testAfterFullRefreshWithImage()
+{
+    SSD1675aEmulator emulator;
+    SSD1675a display(emulator);
+    display.selectLut(LutSelection::Default);
+    display.init();
+
+    const auto image = makeImage(1);
+    display.fullRefresh(image.data(), image.size());
+
+    checkPartialRefresh(display, emulator, {16, 40, 32, 20}, 0xF0);
+
+    // the red RAM has been updated by the first window
+    checkPartialRefresh(display, emulator, {24, 50, 48, 30}, 0x3C);
+    checkPartialRefresh(display, emulator, {0, 0, 152, 8}, 0x00);
+}
+
+//--------------------------------------------------------------------------------------------------
+void testAfterPlaneSubmission()
+{
+    SSD1675aEmulator emulator;
+    SSD1675a display(emulator);
+    display.selectLut(LutSelection::Default);
+    display.init();
+
+    const auto first = makeImage(2);
+    display.submitPlanes(first.data(), nullptr, first.size());
+
+    // the red RAM does not hold the shown image yet
+    std::vector<uint8_t> windowImage(4 * 10, 0xAA);
+    display.partialRefresh(windowImage.data(), {8, 8, 32, 10});
+    expect(display.residentLut() == LutSelection::Default,
+           "partial refresh without previous image refreshes the whole panel");
+
+    // from now on, BW only submissions load the previous image as well
+    const auto second = makeImage(3);
+    display.submitPlanes(second.data(), nullptr, second.size());
+    checkPartialRefresh(display, emulator, {64, 100, 40, 60}, 0x81);
+
+    // red content takes the red RAM back
+    const std::vector<uint8_t> red(PlaneLength, 0x00);
+    display.submitPlanes(second.data(), red.data(), second.size());
+    display.partialRefresh(windowImage.data(), {8, 8, 32, 10});
+    expect(display.residentLut() == LutSelection::Default,
+           "partial refresh after writing red content refreshes the whole panel");
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Checks the LUT selected per pixel by SSD1675a::partialRefresh() with the emulator.
+int main()
+{
+    testAfterFullRefreshWithImage();
+    testAfterPlaneSubmission();
+
+    std::printf("%zu checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
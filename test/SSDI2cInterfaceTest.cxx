@@ -0,0 +1,171 @@
+#include "ssd-display-driver/SSDI2cInterface.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+using Segment = SSDInterface::Segment;
+
+constexpr uint8_t Address = 0x3C;
+constexpr uint8_t CommandStream = 0x00;
+constexpr uint8_t DataStream = 0x40;
+
+size_t failures = 0;
+
+void expect(bool condition, const char *description)
+{
+    if (condition)
+        return;
+
+    std::printf("failed: %s\n", description);
+    ++failures;
+}
+
+/// Records every I2C transaction written by the interface.
+class RecordingBus : public SSDI2cInterface::Bus
+{
+public:
+    void write(uint8_t address, const uint8_t *data, size_t length) override
+    {
+        isAddressCorrect = isAddressCorrect && address == Address;
+        transactions.emplace_back(data, data + length);
+    }
+
+    std::vector<std::vector<uint8_t>> transactions;
+    bool isAddressCorrect = true;
+};
+
+std::vector<uint8_t> makeBytes(size_t length, uint8_t seed)
+{
+    std::vector<uint8_t> bytes(length);
+    for (size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = static_cast<uint8_t>(i * 7 + seed);
+
+    return bytes;
+}
+
+/// Checks that \p transactions carry \p bytes behind \p control, split into parts of at most
+/// \p maxTransferSize bytes, all of them full except for the last one.
+bool isSplit(const std::vector<std::vector<uint8_t>> &transactions, uint8_t control,
+             const std::vector<uint8_t> &bytes, size_t maxTransferSize)
+{
+    const size_t payload = maxTransferSize - 1;
+    const size_t expectedTransactions = (bytes.size() + payload - 1) / payload;
+
+    if (transactions.size() != expectedTransactions)
+        return false;
+
+    std::vector<uint8_t> joined;
+
+    for (size_t i = 0; i < transactions.size(); ++i)
+    {
+        const auto &transaction = transactions[i];
+        const bool isLast = i + 1 == transactions.size();
+
+        if (transaction.empty() || transaction[0] != control)
+            return false;
+
+        const bool isFull = transaction.size() == maxTransferSize;
+        if (transaction.size() > maxTransferSize || (!isLast && !isFull))
+            return false;
+
+        joined.insert(joined.end(), transaction.begin() + 1, transaction.end());
+    }
+
+    return joined == bytes;
+}
+
+//--------------------------------------------------------------------------------------------------
+void testPacking()
+{
+    RecordingBus bus;
+    uint8_t buffer[32];
+    SSDI2cInterface interface(bus, Address, buffer, sizeof(buffer));
+
+    const uint8_t contrast[] = {0x81, 0x7F};
+    interface.writeCommands(contrast, sizeof(contrast));
+    interface.writeCommand(0xAF);
+    interface.writeData(0x55);
+
+    const std::vector<std::vector<uint8_t>> expected = {
+        {CommandStream, 0x81, 0x7F}, {CommandStream, 0xAF}, {DataStream, 0x55}};
+
+    expect(bus.transactions == expected, "each call is one transaction behind one control byte");
+    expect(bus.isAddressCorrect, "transactions are sent to the slave address");
+}
+
+//--------------------------------------------------------------------------------------------------
+void testSplit()
+{
+    // exactly full, one byte more and several parts, for the smallest and a typical buffer
+    for (const size_t maxTransferSize : {2, 8, 32})
+    {
+        const size_t lengths[] = {maxTransferSize - 1, maxTransferSize, 3 * maxTransferSize + 1};
+
+        for (const size_t length : lengths)
+        {
+            RecordingBus bus;
+            std::vector<uint8_t> buffer(maxTransferSize);
+            SSDI2cInterface interface(bus, Address, buffer.data(), buffer.size());
+
+            const auto data = makeBytes(length, 1);
+            interface.writeData(data.data(), data.size());
+            expect(isSplit(bus.transactions, DataStream, data, maxTransferSize),
+                   "data is split at the maximum transfer size");
+
+            bus.transactions.clear();
+
+            const auto commands = makeBytes(length, 2);
+            interface.writeCommands(commands.data(), commands.size());
+            expect(isSplit(bus.transactions, CommandStream, commands, maxTransferSize),
+                   "commands are split at the maximum transfer size");
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void testSegments()
+{
+    RecordingBus bus;
+    uint8_t buffer[8];
+    SSDI2cInterface interface(bus, Address, buffer, sizeof(buffer));
+
+    const auto window = makeBytes(3, 3);
+    const auto start = makeBytes(2, 4);
+    const auto image = makeBytes(10, 5);
+
+    // consecutive segments of the same type share a transaction
+    const Segment segments[] = {{Segment::Type::Command, window.data(), window.size()},
+                                {Segment::Type::Command, start.data(), start.size()},
+                                {Segment::Type::Data, nullptr, 0},
+                                {Segment::Type::Data, image.data(), image.size()}};
+    interface.writeSegments(segments, 4);
+
+    std::vector<uint8_t> commands = window;
+    commands.insert(commands.end(), start.begin(), start.end());
+
+    expect(bus.transactions.size() == 3, "one command and two data transactions");
+    if (bus.transactions.size() != 3)
+        return;
+
+    expect(isSplit({bus.transactions[0]}, CommandStream, commands, sizeof(buffer)),
+           "command segments are joined");
+    expect(isSplit({bus.transactions.begin() + 1, bus.transactions.end()}, DataStream, image,
+                   sizeof(buffer)),
+           "data segment follows and is split");
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+/// Checks the I2C transactions written by SSDI2cInterface against the control byte framing.
+int main()
+{
+    testPacking();
+    testSplit();
+    testSegments();
+
+    std::printf("%zu checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}